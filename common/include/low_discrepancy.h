@@ -0,0 +1,400 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Low-discrepancy (quasi-random) point sets on [0, 1)^dimensions. Every
+// sequence writes its next point as 0.64 fixed-point fractions, and seek(index)
+// jumps to any point in O(digits), so each thread can take a disjoint slice
+// [begin, end) of one sequence. A nonzero seed randomizes the points
+// (randomized QMC): independent seeds give independent, unbiased estimates
+// whose spread estimates the error.
+// QuasiRandomEngine turns any of them into a uniform random bit generator, so
+// they can replace std::mt19937 as the source of the existing samplers.
+
+constexpr int SOBOL_MAX_DIMENSIONS = 21;
+constexpr int HALTON_MAX_DIMENSIONS = 32;
+
+// 64-bit finalizer of splitmix64; seeds per dimension and digit
+inline std::uint64_t mixBits(std::uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+inline double fixedToUnit(std::uint64_t x)
+{
+  return static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Sobol sequence, 32-bit, with the direction numbers of Joe and Kuo
+// (new-joe-kuo-6.21201) for dimensions 2 to 21; dimension 1 is van der Corput.
+// Points follow in Gray-code order, one XOR per coordinate and point.
+// Scrambling is Owen's nested uniform scrambling in the hashed form of
+// Laine-Karras and Burley: in bit-reversed order every bit is flipped by a
+// hash of the bits above it, which keeps each 2^m block of points a (t, m, s)-net.
+class SobolSequence
+{
+private:
+  struct Polynomial
+  {
+    int degree;
+    std::uint32_t coefficients;
+    std::array<std::uint32_t, 7> m;
+  };
+
+  static const Polynomial &polynomial(int dimension)
+  {
+    static const Polynomial table[SOBOL_MAX_DIMENSIONS - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    };
+    return table[dimension - 1];
+  }
+
+  static std::uint32_t reverseBits(std::uint32_t x)
+  {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+  }
+
+  // Multiplying and XOR-ing only carry information toward the high bits, so
+  // after the reversal each bit of x depends on the bits above it alone
+  static std::uint32_t owenScramble(std::uint32_t x, std::uint32_t seed)
+  {
+    x = reverseBits(x);
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return reverseBits(x);
+  }
+
+  int dimensions_;
+  std::uint64_t seed_;
+  std::uint64_t index_ = 0;
+  std::vector<std::array<std::uint32_t, 32>> directions_;
+  std::vector<std::uint32_t> state_;      // the current point, unscrambled
+  std::vector<std::uint32_t> scrambles_;  // Owen seed per dimension
+
+public:
+  explicit SobolSequence(int dimensions, std::uint64_t seed = 0)
+      : dimensions_(dimensions), seed_(seed), directions_(dimensions), state_(dimensions, 0), scrambles_(dimensions)
+  {
+    if (dimensions < 1 || dimensions > SOBOL_MAX_DIMENSIONS)
+    {
+      throw std::invalid_argument("sobol: dimensions must be 1 to 21");
+    }
+    for (int k = 0; k < 32; k++)
+    {
+      directions_[0][k] = 1u << (31 - k);
+    }
+    for (int d = 1; d < dimensions; d++)
+    {
+      const Polynomial &p = polynomial(d);
+      std::array<std::uint32_t, 32> &v = directions_[d];
+      for (int k = 0; k < p.degree; k++)
+      {
+        v[k] = p.m[k] << (31 - k);
+      }
+      for (int k = p.degree; k < 32; k++)
+      {
+        v[k] = v[k - p.degree] ^ (v[k - p.degree] >> p.degree);
+        for (int j = 1; j < p.degree; j++)
+        {
+          v[k] ^= ((p.coefficients >> (p.degree - 1 - j)) & 1) * v[k - j];
+        }
+      }
+    }
+    for (int d = 0; d < dimensions; d++)
+    {
+      scrambles_[d] = static_cast<std::uint32_t>(mixBits(seed ^ mixBits(d)));
+    }
+  }
+
+  int dimensions() const
+  {
+    return dimensions_;
+  }
+
+  std::uint64_t index() const
+  {
+    return index_;
+  }
+
+  // Point `index` is the XOR of the directions at the set bits of its Gray code
+  void seek(std::uint64_t index)
+  {
+    if (index > std::numeric_limits<std::uint32_t>::max())
+    {
+      throw std::out_of_range("sobol: only 2^32 points");
+    }
+    index_ = index;
+    std::uint64_t gray = index ^ (index >> 1);
+    for (int d = 0; d < dimensions_; d++)
+    {
+      state_[d] = 0;
+      for (int k = 0; gray >> k != 0; k++)
+      {
+        state_[d] ^= ((gray >> k) & 1) * directions_[d][k];
+      }
+    }
+  }
+
+  void next(std::uint64_t *point)
+  {
+    for (int d = 0; d < dimensions_; d++)
+    {
+      if (seed_ == 0)
+      {
+        point[d] = static_cast<std::uint64_t>(state_[d]) << 32;
+      }
+      else
+      {
+        // Owen scrambling randomizes every digit, including those past 32 bits
+        std::uint32_t x = owenScramble(state_[d], scrambles_[d]);
+        point[d] = static_cast<std::uint64_t>(x) << 32 | (mixBits(x ^ (seed_ + d)) >> 32);
+      }
+    }
+    // Gray codes of index and index + 1 differ at the lowest set bit of index + 1
+    index_++;
+    int k = __builtin_ctzll(index_);
+    if (k < 32)
+    {
+      for (int d = 0; d < dimensions_; d++)
+      {
+        state_[d] ^= directions_[d][k];
+      }
+    }
+  }
+};
+
+// Halton sequence: dimension d is the radical inverse of the index in the d-th
+// prime base. Scrambling is Owen-style nested: digit k is shifted mod the base
+// by a hash of the digits before it (all digits, down to 2^-53), which keeps
+// the stratification of the unscrambled points.
+class HaltonSequence
+{
+private:
+  static int prime(int dimension)
+  {
+    static const int primes[HALTON_MAX_DIMENSIONS] = {2,  3,  5,  7,  11, 13, 17, 19, 23, 29,  31,
+                                                      37, 41, 43, 47, 53, 59, 61, 67, 71, 73,  79,
+                                                      83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+    return primes[dimension];
+  }
+
+  int dimensions_;
+  std::uint64_t seed_;
+  std::uint64_t index_ = 0;
+  std::vector<int> digits_;  // digits of each base that resolve 2^-53
+
+  double radicalInverse(int d, std::uint64_t n) const
+  {
+    std::uint64_t base = prime(d);
+    double scale = 1.0 / base;
+    double result = 0;
+    if (seed_ == 0)
+    {
+      for (; n != 0; n /= base, scale /= base)
+      {
+        result += (n % base) * scale;
+      }
+      return result;
+    }
+    std::uint64_t dimensionSeed = mixBits(seed_ ^ mixBits(d));
+    std::uint64_t prefix = 0;  // value of the digits already placed
+    std::uint64_t weight = 1;  // base^k
+    for (int k = 0; k < digits_[d]; k++, n /= base, scale /= base)
+    {
+      std::uint64_t digit = n % base;
+      std::uint64_t shift = mixBits(dimensionSeed ^ mixBits(prefix * HALTON_MAX_DIMENSIONS * 64 + k)) % base;
+      result += ((digit + shift) % base) * scale;
+      prefix += digit * weight;
+      weight *= base;
+    }
+    return result;
+  }
+
+public:
+  explicit HaltonSequence(int dimensions, std::uint64_t seed = 0)
+      : dimensions_(dimensions), seed_(seed), digits_(dimensions)
+  {
+    if (dimensions < 1 || dimensions > HALTON_MAX_DIMENSIONS)
+    {
+      throw std::invalid_argument("halton: dimensions must be 1 to 32");
+    }
+    for (int d = 0; d < dimensions; d++)
+    {
+      digits_[d] = static_cast<int>(std::ceil(53 / std::log2(prime(d))));
+    }
+  }
+
+  int dimensions() const
+  {
+    return dimensions_;
+  }
+
+  std::uint64_t index() const
+  {
+    return index_;
+  }
+
+  void seek(std::uint64_t index)
+  {
+    index_ = index;
+  }
+
+  void next(std::uint64_t *point)
+  {
+    for (int d = 0; d < dimensions_; d++)
+    {
+      point[d] = static_cast<std::uint64_t>(std::ldexp(radicalInverse(d, index_), 64));
+    }
+    index_++;
+  }
+};
+
+// Roberts' R_d sequence ("R2" in two dimensions): x_n = frac(1/2 + n alpha)
+// with alpha_j = phi^-(j + 1), where phi is the root of x^(d + 1) = x + 1.
+// It is a Kronecker sequence, computed exactly in wrapping 64-bit fixed point.
+// It has no digits to scramble; a seed adds a random shift mod 1
+// (Cranley-Patterson), the randomization that fits lattice-like sequences.
+class R2Sequence
+{
+private:
+  int dimensions_;
+  std::uint64_t index_ = 0;
+  std::vector<std::uint64_t> alpha_;
+  std::vector<std::uint64_t> offset_;
+
+public:
+  explicit R2Sequence(int dimensions, std::uint64_t seed = 0)
+      : dimensions_(dimensions), alpha_(dimensions), offset_(dimensions)
+  {
+    if (dimensions < 1)
+    {
+      throw std::invalid_argument("r2: dimensions must be positive");
+    }
+    long double phi = 2;
+    for (int i = 0; i < 64; i++)
+    {
+      phi = std::pow(1 + phi, 1.0L / (dimensions + 1));
+    }
+    long double alpha = 1;
+    for (int d = 0; d < dimensions; d++)
+    {
+      alpha /= phi;
+      alpha_[d] = static_cast<std::uint64_t>(std::ldexp(alpha, 64));
+      offset_[d] = (1ULL << 63) + (seed == 0 ? 0 : mixBits(seed ^ mixBits(d)));
+    }
+  }
+
+  int dimensions() const
+  {
+    return dimensions_;
+  }
+
+  std::uint64_t index() const
+  {
+    return index_;
+  }
+
+  void seek(std::uint64_t index)
+  {
+    index_ = index;
+  }
+
+  void next(std::uint64_t *point)
+  {
+    for (int d = 0; d < dimensions_; d++)
+    {
+      point[d] = offset_[d] + index_ * alpha_[d];
+    }
+    index_++;
+  }
+};
+
+// Uniform random bit generator over a low-discrepancy sequence: calls return
+// the coordinates of one point after another, so a sampler that draws
+// `dimensions` uniforms per sample gets exactly one point per sample. Every
+// output is one 64-bit fraction, which std::uniform_real_distribution<double>
+// consumes one at a time.
+// Only samplers that map each output to one uniform by inversion may use it
+// (ExpRandom, XRandom, ValueSampler, AliasTable). The outputs are not random
+// bits: the low 32 bits of an unscrambled Sobol coordinate are zero, and a
+// Halton coordinate only has about 53 significant bits. Rejection samplers
+// such as the ziggurats take bits from the bottom and a varying number of
+// outputs per sample, which breaks both the distribution and the point
+// structure; they reject this engine at compile time.
+template <typename Sequence>
+class QuasiRandomEngine
+{
+private:
+  Sequence sequence_;
+  std::vector<std::uint64_t> point_;
+  int next_;
+
+public:
+  using result_type = std::uint64_t;
+  using sequence_type = Sequence;
+
+  explicit QuasiRandomEngine(const Sequence &sequence)
+      : sequence_(sequence), point_(sequence.dimensions()), next_(sequence.dimensions())
+  {
+  }
+
+  static constexpr result_type min()
+  {
+    return 0;
+  }
+
+  static constexpr result_type max()
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()()
+  {
+    if (next_ == sequence_.dimensions())
+    {
+      sequence_.next(point_.data());
+      next_ = 0;
+    }
+    return point_[next_++];
+  }
+
+  // Continues at point `index` of the sequence
+  void seek(std::uint64_t index)
+  {
+    sequence_.seek(index);
+    next_ = sequence_.dimensions();
+  }
+};
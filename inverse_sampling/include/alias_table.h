@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "inverse_random.h"
+
+// Walker's alias method with Vose's construction: a discrete distribution over
+// 0..n-1 becomes n columns of equal probability, column i holding i with
+// probability prob_[i] and alias_[i] otherwise. A draw scales one uniform by n;
+// the integer part picks the column and the fraction decides between i and its
+// alias, so every draw is O(1) whatever the weights.
+class AliasTable
+{
+public:
+  // Weights need not be normalized
+  explicit AliasTable(const std::vector<double> &weights) : prob_(weights.size()), alias_(weights.size())
+  {
+    std::size_t n = weights.size();
+    double total = 0;
+    for (double w : weights)
+    {
+      if (w < 0)
+      {
+        throw std::invalid_argument("alias table: negative weight");
+      }
+      total += w;
+    }
+    if (n == 0 || !(total > 0))
+    {
+      throw std::invalid_argument("alias table: no positive weight");
+    }
+
+    // Scaled so the mean is 1; columns below 1 are topped up from ones above
+    std::vector<double> scaled(n);
+    std::vector<std::size_t> small, large;
+    for (std::size_t i = 0; i < n; i++)
+    {
+      scaled[i] = weights[i] * n / total;
+      (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+      std::size_t less = small.back();
+      std::size_t more = large.back();
+      small.pop_back();
+      prob_[less] = scaled[less];
+      alias_[less] = more;
+      scaled[more] -= 1 - scaled[less];
+      if (scaled[more] < 1)
+      {
+        large.pop_back();
+        small.push_back(more);
+      }
+    }
+    // Whatever is left is 1 up to rounding
+    for (std::size_t i : large)
+    {
+      prob_[i] = 1;
+      alias_[i] = i;
+    }
+    for (std::size_t i : small)
+    {
+      prob_[i] = 1;
+      alias_[i] = i;
+    }
+  }
+
+  std::size_t size() const
+  {
+    return prob_.size();
+  }
+
+  template <typename Engine>
+  std::size_t operator()(Engine &engine) const
+  {
+    double u = static_cast<double>(random64(engine) >> 11) * (1.0 / 9007199254740992.0) * prob_.size();
+    // min: u * n may round up to n when n is large
+    std::size_t column = std::min(static_cast<std::size_t>(u), prob_.size() - 1);
+    return u - column < prob_[column] ? column : alias_[column];
+  }
+
+  template <typename Engine>
+  void fill(Engine &engine, std::size_t *out, std::size_t size) const
+  {
+    for (std::size_t i = 0; i < size; i++)
+    {
+      out[i] = (*this)(engine);
+    }
+  }
+
+private:
+  std::vector<double> prob_;
+  std::vector<std::size_t> alias_;
+};
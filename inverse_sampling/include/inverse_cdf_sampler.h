@@ -0,0 +1,241 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "inverse_random.h"
+
+// Cells the domain is split into before refinement
+constexpr int INVERSE_CDF_INITIAL_CELLS = 32;
+// Guide table entries per cell; more entries mean fewer cells to step over per draw
+constexpr int INVERSE_CDF_GUIDE_FACTOR = 4;
+// Cells narrower than this fraction of the domain are accepted as they are
+constexpr double INVERSE_CDF_MIN_WIDTH = 1e-13;
+// Smallest tolerance accepted; below it rounding in the cdf differences keeps
+// cells from ever passing and refinement runs until memory is exhausted
+constexpr double INVERSE_CDF_MIN_TOLERANCE = 1e-15;
+// Most cells a sampler may have (about 20 MB of tables); a cdf whose own
+// evaluation error is above the tolerance would otherwise refine without end
+constexpr std::size_t INVERSE_CDF_MAX_CELLS = 1 << 18;
+// Step of the central differences of fromCdf without a pdf, relative to the domain
+constexpr double INVERSE_CDF_DIFFERENCE_STEP = 1e-6;
+
+// Inverse transform sampling for any distribution on [a, b] given by its CDF or
+// PDF (unnormalized is fine), without root finding per draw.
+// At construction the domain is cut into cells, and on each cell x(u) = F^-1(u)
+// is replaced by the cubic Hermite polynomial through the two end points with
+// slopes 1 / pdf (linear where that cubic would not be monotone, e.g. where the
+// pdf is 0). A cell is halved until |F(x(u)) - u| <= tolerance, checked at
+// u = 1/4, 1/2 and 3/4 of the cell; between those points the error is not
+// bounded, only small in practice. The tolerance is relative to the total mass
+// and must be at least INVERSE_CDF_MIN_TOLERANCE, and construction fails with
+// invalid_argument rather than grow past INVERSE_CDF_MAX_CELLS cells.
+// A guide table over u finds the cell of a draw in about one comparison, and a
+// draw costs one uniform and one cubic.
+class InverseCdfSampler
+{
+public:
+  using Function = std::function<double(double)>;
+
+  // cdf and pdf of the distribution restricted to [a, b]
+  static InverseCdfSampler fromCdf(const Function &cdf, const Function &pdf, double a, double b,
+                                   double tolerance = 1e-10)
+  {
+    auto mass = [&](double l, double r) { return cdf(r) - cdf(l); };
+    return InverseCdfSampler(mass, pdf, a, b, tolerance);
+  }
+
+  // cdf alone; the slopes come from central differences of the cdf. Their
+  // error only costs cells, since every cell is still checked against the cdf.
+  static InverseCdfSampler fromCdf(const Function &cdf, double a, double b, double tolerance = 1e-10)
+  {
+    double h = (b - a) * INVERSE_CDF_DIFFERENCE_STEP;
+    auto pdf = [&](double x) {
+      double l = std::max(a, x - h);
+      double r = std::min(b, x + h);
+      return (cdf(r) - cdf(l)) / (r - l);
+    };
+    return fromCdf(cdf, pdf, a, b, tolerance);
+  }
+
+  // The cdf is the integral of pdf, by 5-point Gauss-Legendre on every cell
+  static InverseCdfSampler fromPdf(const Function &pdf, double a, double b, double tolerance = 1e-10)
+  {
+    auto mass = [&](double l, double r) {
+      static const double nodes[] = {0, 0.5384693101056831, 0.9061798459386640};
+      static const double weights[] = {0.5688888888888889, 0.4786286704993665, 0.2369268850561891};
+      double center = (l + r) / 2;
+      double half = (r - l) / 2;
+      double sum = weights[0] * pdf(center);
+      for (int i = 1; i < 3; i++)
+      {
+        sum += weights[i] * (pdf(center - half * nodes[i]) + pdf(center + half * nodes[i]));
+      }
+      return sum * half;
+    };
+    return InverseCdfSampler(mass, pdf, a, b, tolerance);
+  }
+
+  // F^-1(u) for u in [0, 1]
+  double inverse(double u) const
+  {
+    std::size_t k = guide_[std::min(static_cast<std::size_t>(u * guide_.size()), guide_.size() - 1)];
+    while (uStart_[k + 1] <= u && k + 2 < uStart_.size())
+    {
+      k++;
+    }
+    double t = (u - uStart_[k]) * uScale_[k];
+    const double *c = &coefficients_[4 * k];
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+  }
+
+  template <typename Engine>
+  double operator()(Engine &engine) const
+  {
+    return inverse(uniformOpenZero(engine));
+  }
+
+  template <typename Engine>
+  void fill(Engine &engine, double *out, std::size_t size) const
+  {
+    for (std::size_t i = 0; i < size; i++)
+    {
+      out[i] = (*this)(engine);
+    }
+  }
+
+  std::size_t cells() const
+  {
+    return uScale_.size();
+  }
+
+private:
+  using Mass = std::function<double(double, double)>;
+  using Cubic = std::array<double, 4>;
+
+  // mass(l, r) is the unnormalized probability of [l, r]
+  InverseCdfSampler(const Mass &mass, const Function &pdf, double a, double b, double tolerance)
+  {
+    if (!(a < b))
+    {
+      throw std::invalid_argument("inverse cdf: empty domain");
+    }
+    if (!(tolerance >= INVERSE_CDF_MIN_TOLERANCE))
+    {
+      throw std::invalid_argument("inverse cdf: tolerance below 1e-15");
+    }
+    auto node = [&](int i) { return i == INVERSE_CDF_INITIAL_CELLS ? b : a + (b - a) * i / INVERSE_CDF_INITIAL_CELLS; };
+    double total = 0;
+    for (int i = 0; i < INVERSE_CDF_INITIAL_CELLS; i++)
+    {
+      total += mass(node(i), node(i + 1));
+    }
+    if (!(total > 0))
+    {
+      throw std::invalid_argument("inverse cdf: no probability mass on the domain");
+    }
+
+    double cumulative = 0;
+    uStart_.push_back(0);
+    for (int i = 0; i < INVERSE_CDF_INITIAL_CELLS; i++)
+    {
+      refine(mass, pdf, node(i), node(i + 1), pdf(node(i)), pdf(node(i + 1)), cumulative, tolerance * total,
+             (b - a) * INVERSE_CDF_MIN_WIDTH);
+    }
+
+    // The polynomials are in the position t within a cell, so only the cell
+    // boundaries need scaling to [0, 1]
+    for (double &u : uStart_)
+    {
+      u /= cumulative;
+    }
+    uStart_.back() = 1;
+
+    std::size_t cells = uStart_.size() - 1;
+    uScale_.resize(cells);
+    for (std::size_t k = 0; k < cells; k++)
+    {
+      uScale_[k] = uStart_[k + 1] > uStart_[k] ? 1 / (uStart_[k + 1] - uStart_[k]) : 0;
+    }
+    guide_.resize(INVERSE_CDF_GUIDE_FACTOR * cells);
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < guide_.size(); i++)
+    {
+      while (k + 1 < cells && uStart_[k + 1] <= static_cast<double>(i) / guide_.size())
+      {
+        k++;
+      }
+      guide_[i] = k;
+    }
+  }
+
+  // x(t) on [l, r] for t in [0, 1], where the cell holds mass du
+  static Cubic fit(double l, double r, double pl, double pr, double du)
+  {
+    double dx = r - l;
+    if (pl > 0 && pr > 0)
+    {
+      double m0 = du / pl;
+      double m1 = du / pr;
+      // Fritsch-Carlson: the cubic is monotone when the scaled slopes lie in
+      // the circle of radius 3
+      double alpha = m0 / dx;
+      double beta = m1 / dx;
+      if (alpha * alpha + beta * beta <= 9)
+      {
+        return {l, m0, 3 * dx - 2 * m0 - m1, -2 * dx + m0 + m1};
+      }
+    }
+    return {l, dx, 0, 0};
+  }
+
+  static double evaluate(const Cubic &c, double t)
+  {
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+  }
+
+  // Fits the cell [l, r] or halves it, left half first so cells stay in order
+  void refine(const Mass &mass, const Function &pdf, double l, double r, double pl, double pr, double &cumulative,
+              double tolerance, double minWidth)
+  {
+    double du = mass(l, r);
+    Cubic c = fit(l, r, pl, pr, du);
+    bool accepted = true;
+    if (du > tolerance && r - l > minWidth)
+    {
+      for (double t : {0.25, 0.5, 0.75})
+      {
+        double x = std::min(std::max(evaluate(c, t), l), r);
+        if (std::abs(mass(l, x) - t * du) > tolerance)
+        {
+          accepted = false;
+          break;
+        }
+      }
+    }
+    if (accepted)
+    {
+      if (uStart_.size() > INVERSE_CDF_MAX_CELLS)
+      {
+        throw std::invalid_argument("inverse cdf: more than 262144 cells; the cdf is too noisy for the tolerance");
+      }
+      cumulative += du;
+      uStart_.push_back(cumulative);
+      coefficients_.insert(coefficients_.end(), c.begin(), c.end());
+      return;
+    }
+    double m = l + (r - l) / 2;
+    double pm = pdf(m);
+    refine(mass, pdf, l, m, pl, pm, cumulative, tolerance, minWidth);
+    refine(mass, pdf, m, r, pm, pr, cumulative, tolerance, minWidth);
+  }
+
+  std::vector<double> uStart_;       // u at the start of each cell, and 1 at the end
+  std::vector<double> coefficients_; // 4 per cell, x(t) = c0 + c1 t + c2 t^2 + c3 t^3
+  std::vector<double> uScale_;       // 1 / width of each cell in u
+  std::vector<std::size_t> guide_;   // guide_[i]: the cell holding u = i / guide_.size()
+};
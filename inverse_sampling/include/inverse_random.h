@@ -0,0 +1,160 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+#include "vector_log.h"
+
+// Values generated per pass of a batch fill; the uniforms and their logs stay in L1
+constexpr std::size_t INVERSE_RANDOM_BATCH = 512;
+
+// 64 random bits, from two calls of a 32-bit engine such as std::mt19937; a
+// 64-bit engine (or a quasi-random one) is called once
+template <typename Engine>
+std::uint64_t random64(Engine &engine)
+{
+  if (Engine::max() - Engine::min() >= 0xffffffffffffffffULL)
+  {
+    return engine() - Engine::min();
+  }
+  std::uint64_t high = engine() & 0xffffffffULL;
+  return high << 32 | (engine() & 0xffffffffULL);
+}
+
+// True for a QuasiRandomEngine (low_discrepancy.h): its outputs are coordinates
+// of low-discrepancy points, not independent random bits
+template <typename Engine, typename = void>
+struct IsQuasiRandomEngine : std::false_type
+{
+};
+
+template <typename Engine>
+struct IsQuasiRandomEngine<Engine, std::void_t<typename Engine::sequence_type>> : std::true_type
+{
+};
+
+// Uniform double in (0, 1] with the top 53 of 64 random bits.
+// Zero is excluded so that the log of every value is finite.
+template <typename Engine>
+double uniformOpenZero(Engine &engine)
+{
+  return static_cast<double>((random64(engine) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+template <typename Engine>
+void fillUniformOpenZero(Engine &engine, double *out, std::size_t size)
+{
+  for (std::size_t i = 0; i < size; i++)
+  {
+    out[i] = uniformOpenZero(engine);
+  }
+}
+
+// Random number from inverse function of probability density function of exponential distribution
+class ExpRandom
+{
+private:
+  // mean: meu
+  // u = U[0,1]
+  inline double invProbExpFunc(const double &u)
+  {
+    return -meu_ * std::log(1 - u);
+  }
+
+  std::random_device seed_gen;
+  std::mt19937 engine = std::mt19937(seed_gen());
+  std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0, 1);
+
+  double meu_;
+
+public:
+  ExpRandom(double meu) : meu_(meu) {}
+
+  void setMeu(double meu)
+  {
+    meu_ = meu;
+  }
+
+  double getNext()
+  {
+    return invProbExpFunc(dist(engine));
+  }
+
+  // With another uniform source, e.g. a QuasiRandomEngine
+  template <typename Engine>
+  double getNext(Engine &source)
+  {
+    return invProbExpFunc(dist(source));
+  }
+
+  // Fills out[0..size) with samples. Uniforms are drawn in batches, their logs
+  // taken with logBatch and scaled in place; 1 - U is replaced by U in (0, 1],
+  // which has the same distribution.
+  void fill(double *out, std::size_t size, LogMode mode = LogMode::Polynomial)
+  {
+    fill(engine, out, size, mode);
+  }
+
+  template <typename Engine>
+  void fill(Engine &source, double *out, std::size_t size, LogMode mode = LogMode::Polynomial)
+  {
+    for (std::size_t begin = 0; begin < size; begin += INVERSE_RANDOM_BATCH)
+    {
+      std::size_t count = std::min(INVERSE_RANDOM_BATCH, size - begin);
+      double *batch = out + begin;
+      fillUniformOpenZero(source, batch, count);
+      logBatch(batch, batch, count, mode);
+      for (std::size_t i = 0; i < count; i++)
+      {
+        batch[i] *= -meu_;
+      }
+    }
+  }
+};
+
+class XRandom
+{
+private:
+  // mean: meu
+  // u = U[0,1]
+  inline double inv_comu_pdf(const double &u)
+  {
+    return 2 * std::sqrt(u);
+  }
+
+  std::random_device seed_gen;
+  std::mt19937 engine = std::mt19937(seed_gen());
+  std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0, 1);
+
+
+public:
+
+
+  double getNext()
+  {
+    return inv_comu_pdf(dist(engine));
+  }
+
+  template <typename Engine>
+  double getNext(Engine &source)
+  {
+    return inv_comu_pdf(dist(source));
+  }
+
+  void fill(double *out, std::size_t size)
+  {
+    fill(engine, out, size);
+  }
+
+  template <typename Engine>
+  void fill(Engine &source, double *out, std::size_t size)
+  {
+    for (std::size_t i = 0; i < size; i++)
+    {
+      out[i] = inv_comu_pdf(dist(source));
+    }
+  }
+};
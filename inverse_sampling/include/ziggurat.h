@@ -0,0 +1,185 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "inverse_random.h"
+
+// Layers of equal area under the density; 8 bits of a draw pick one
+constexpr int ZIGGURAT_LAYERS = 256;
+
+// Ziggurat method (Marsaglia and Tsang) for a decreasing density f on [0, inf).
+// The area under f is covered by ZIGGURAT_LAYERS stacked rectangles of equal
+// area v: layer i spans [0, x[i]] between heights f(x[i]) and f(x[i + 1]), and
+// the bottom layer 0 is the rectangle below f(r) plus the tail beyond r = x[1],
+// given the width x[0] = v / f(r). A draw picks a layer and a point x in it;
+// x < x[i + 1] lies under the curve for sure, which decides about 99% of the
+// draws with one multiply and one compare and no transcendental function.
+// The rest test the wedge between the rectangle and the curve, or sample the
+// tail.
+// The layer and sign come from the low bits of a draw and a sample takes a
+// varying number of draws, so the engine must supply independent random bits;
+// a QuasiRandomEngine is rejected at compile time.
+struct ZigguratTable
+{
+  std::array<double, ZIGGURAT_LAYERS + 1> x;     // layer widths, x[ZIGGURAT_LAYERS] = 0
+  std::array<double, ZIGGURAT_LAYERS + 1> f;     // f(x[i])
+  std::array<double, ZIGGURAT_LAYERS> inside;    // x[i + 1] / x[i]: below it a point is under the curve
+
+  // r and v are the tail start and the layer area for ZIGGURAT_LAYERS layers
+  template <typename Density, typename Inverse>
+  ZigguratTable(Density density, Inverse inverse, double r, double v)
+  {
+    x[0] = v / density(r);
+    x[1] = r;
+    for (int i = 1; i < ZIGGURAT_LAYERS; i++)
+    {
+      double y = density(x[i]) + v / x[i];
+      x[i + 1] = y < 1 ? inverse(y) : 0;
+    }
+    x[ZIGGURAT_LAYERS] = 0;
+    for (int i = 0; i <= ZIGGURAT_LAYERS; i++)
+    {
+      f[i] = density(x[i]);
+    }
+    for (int i = 0; i < ZIGGURAT_LAYERS; i++)
+    {
+      inside[i] = x[i + 1] / x[i];
+    }
+  }
+};
+
+// Exponential with mean meu
+class ZigguratExponential
+{
+public:
+  ZigguratExponential(double meu) : meu_(meu) {}
+
+  template <typename Engine>
+  double operator()(Engine &engine) const
+  {
+    return meu_ * standard(engine);
+  }
+
+  template <typename Engine>
+  void fill(Engine &engine, double *out, std::size_t size) const
+  {
+    for (std::size_t i = 0; i < size; i++)
+    {
+      out[i] = meu_ * standard(engine);
+    }
+  }
+
+private:
+  // Exp(1), f(x) = exp(-x); r and v from Marsaglia and Tsang for 256 layers
+  static const ZigguratTable &table()
+  {
+    static const ZigguratTable table([](double x) { return std::exp(-x); }, [](double y) { return -std::log(y); },
+                                     7.69711747013104972, 0.0039496598225815571993);
+    return table;
+  }
+
+  template <typename Engine>
+  static double standard(Engine &engine)
+  {
+    static_assert(!IsQuasiRandomEngine<Engine>::value, "the ziggurat needs independent random bits");
+    const ZigguratTable &t = table();
+    double shift = 0;
+    while (true)
+    {
+      std::uint64_t bits = random64(engine);
+      int i = static_cast<int>(bits & (ZIGGURAT_LAYERS - 1));
+      double u = static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+      if (u < t.inside[i])
+      {
+        return shift + u * t.x[i];
+      }
+      if (i == 0)
+      {
+        // The tail beyond r is r plus another Exp(1), by memorylessness
+        shift += t.x[1];
+        continue;
+      }
+      double x = u * t.x[i];
+      if (t.f[i] + uniformOpenZero(engine) * (t.f[i + 1] - t.f[i]) < std::exp(-x))
+      {
+        return shift + x;
+      }
+    }
+  }
+
+  double meu_;
+};
+
+// Normal with the given mean and standard deviation
+class ZigguratNormal
+{
+public:
+  ZigguratNormal(double mean = 0, double sigma = 1) : mean_(mean), sigma_(sigma) {}
+
+  template <typename Engine>
+  double operator()(Engine &engine) const
+  {
+    return mean_ + sigma_ * standard(engine);
+  }
+
+  template <typename Engine>
+  void fill(Engine &engine, double *out, std::size_t size) const
+  {
+    for (std::size_t i = 0; i < size; i++)
+    {
+      out[i] = mean_ + sigma_ * standard(engine);
+    }
+  }
+
+private:
+  // |N(0, 1)|, f(x) = exp(-x^2 / 2); r and v for 256 layers
+  static const ZigguratTable &table()
+  {
+    static const ZigguratTable table([](double x) { return std::exp(-x * x / 2); },
+                                     [](double y) { return std::sqrt(-2 * std::log(y)); }, 3.6541528853610088,
+                                     0.00492867323399);
+    return table;
+  }
+
+  template <typename Engine>
+  static double standard(Engine &engine)
+  {
+    static_assert(!IsQuasiRandomEngine<Engine>::value, "the ziggurat needs independent random bits");
+    const ZigguratTable &t = table();
+    while (true)
+    {
+      // 8 bits pick the layer, 1 the sign, the top 53 the position
+      std::uint64_t bits = random64(engine);
+      int i = static_cast<int>(bits & (ZIGGURAT_LAYERS - 1));
+      double sign = bits & ZIGGURAT_LAYERS ? -1 : 1;
+      double u = static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+      if (u < t.inside[i])
+      {
+        return sign * u * t.x[i];
+      }
+      if (i == 0)
+      {
+        // Marsaglia's tail method: r + x with x ~ Exp(r), accepted with
+        // probability exp(-x^2 / 2)
+        double r = t.x[1];
+        double x, y;
+        do
+        {
+          x = -std::log(uniformOpenZero(engine)) / r;
+          y = -std::log(uniformOpenZero(engine));
+        } while (2 * y < x * x);
+        return sign * (r + x);
+      }
+      double x = u * t.x[i];
+      if (t.f[i] + uniformOpenZero(engine) * (t.f[i + 1] - t.f[i]) < std::exp(-x * x / 2))
+      {
+        return sign * x;
+      }
+    }
+  }
+
+  double mean_;
+  double sigma_;
+};
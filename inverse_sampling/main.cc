@@ -1,65 +1,342 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <random>
 #include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-// Random number from inverse function of probability density function of exponential distribution
-class ExpRandom
+#include "alias_table.h"
+#include "inverse_cdf_sampler.h"
+#include "inverse_random.h"
+#include "low_discrepancy.h"
+#include "ziggurat.h"
+
+// Samples per second of getNext against fill with each log mode, with the
+// sample mean as a sanity check, then logBatch alone and the largest relative
+// error of the polynomial log
+void printBatchBenchmark(std::size_t count, double meu)
 {
-private:
-  // mean: meu
-  // u = U[0,1]
-  inline double invProbExpFunc(const double &u)
+  ExpRandom rand(meu);
+  std::vector<double> samples(count);
+
+  auto report = [&](const std::string &name, double seconds) {
+    double sum = 0;
+    for (double x : samples)
+    {
+      sum += x;
+    }
+    std::cout << name << ": " << seconds * 1000 << " ms, " << count / seconds << " samples/s, mean = " << sum / count
+              << "\n";
+  };
+
+  auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; i++)
   {
-    return -meu_ * std::log(1 - u);
+    samples[i] = rand.getNext();
   }
+  auto end = std::chrono::steady_clock::now();
+  report("getNext", std::chrono::duration<double>(end - begin).count());
 
-  std::random_device seed_gen;
-  std::mt19937 engine = std::mt19937(seed_gen());
-  std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0, 1);
+  begin = std::chrono::steady_clock::now();
+  rand.fill(samples.data(), count, LogMode::Exact);
+  end = std::chrono::steady_clock::now();
+  report("fill exact", std::chrono::duration<double>(end - begin).count());
 
-  double meu_;
+  begin = std::chrono::steady_clock::now();
+  rand.fill(samples.data(), count, LogMode::Polynomial);
+  end = std::chrono::steady_clock::now();
+  report("fill polynomial", std::chrono::duration<double>(end - begin).count());
 
-public:
-  ExpRandom(double meu) : meu_(meu) {}
+  // The log alone, without the engine that dominates the fills above
+  std::mt19937 engine(1);
+  std::vector<double> u(count), approx(count);
+  fillUniformOpenZero(engine, u.data(), count);
+  for (LogMode mode : {LogMode::Exact, LogMode::Polynomial})
+  {
+    begin = std::chrono::steady_clock::now();
+    logBatch(u.data(), approx.data(), count, mode);
+    end = std::chrono::steady_clock::now();
+    std::cout << "logBatch " << (mode == LogMode::Exact ? "exact" : "polynomial") << ": "
+              << count / std::chrono::duration<double>(end - begin).count() << " values/s\n";
+  }
+  double worst = 0;
+  for (std::size_t i = 0; i < count; i++)
+  {
+    double exact = std::log(u[i]);
+    if (exact != 0)
+    {
+      worst = std::max(worst, std::abs(approx[i] - exact) / std::abs(exact));
+    }
+  }
+  std::cout << "polynomial log max relative error = " << worst << " (avx2 " << (vectorLogHasAvx2() ? "on" : "off")
+            << ")\n";
+}
 
-  void setMeu(double meu)
+// One tabulated sampler against its closed form: the largest error in u
+// (|F(x) - u|) and in x over a grid of u, then the time per draw of both
+template <typename Closed>
+void printInverseCheck(const std::string &name, const InverseCdfSampler &sampler, const InverseCdfSampler::Function &cdf,
+                       const std::function<double(double)> &inverse, Closed &closed, std::size_t count)
+{
+  const int grid = 1000000;
+  double uError = 0;
+  double xError = 0;
+  for (int i = 0; i <= grid; i++)
   {
-    meu_ = meu;
+    // Stay off u = 1, where the closed forms of unbounded distributions diverge
+    double u = (i + 0.5) / (grid + 1);
+    double x = sampler.inverse(u);
+    uError = std::max(uError, std::abs(cdf(x) - u));
+    xError = std::max(xError, std::abs(x - inverse(u)));
   }
 
-  double getNext()
+  std::mt19937 engine(1);
+  double sum = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; i++)
   {
-    return invProbExpFunc(dist(engine));
+    sum += sampler(engine);
   }
-};
+  auto end = std::chrono::steady_clock::now();
+  double closedSum = 0;
+  for (std::size_t i = 0; i < count; i++)
+  {
+    closedSum += closed.getNext();
+  }
+  auto closedEnd = std::chrono::steady_clock::now();
+
+  std::cout << name << ": " << sampler.cells() << " cells, max u error = " << uError << ", max x error = " << xError
+            << "\n";
+  std::cout << "  tabulated " << count / std::chrono::duration<double>(end - begin).count() << " samples/s, mean = "
+            << sum / count << "; closed form " << count / std::chrono::duration<double>(closedEnd - end).count()
+            << " samples/s, mean = " << closedSum / count << "\n";
+}
+
+// Exponential from its cdf and pdf and from its cdf alone, truncated where the
+// tail mass is e^-40, and ExpRandom's neighbour XRandom (pdf x / 2 on [0, 2])
+// from its pdf alone
+void printInverseCdfCheck(std::size_t count, double tolerance)
+{
+  const double meu = 100;
+  auto expCdf = [=](double x) { return -std::expm1(-x / meu); };
+  auto expPdf = [=](double x) { return std::exp(-x / meu) / meu; };
+  InverseCdfSampler exponential = InverseCdfSampler::fromCdf(expCdf, expPdf, 0, 40 * meu, tolerance);
+  ExpRandom expRandom(meu);
+  printInverseCheck("exponential", exponential, expCdf, [=](double u) { return -meu * std::log1p(-u); }, expRandom,
+                    count);
+  InverseCdfSampler exponentialCdf = InverseCdfSampler::fromCdf(expCdf, 0, 40 * meu, tolerance);
+  printInverseCheck("exponential, cdf only", exponentialCdf, expCdf, [=](double u) { return -meu * std::log1p(-u); },
+                    expRandom, count);
+
+  auto xPdf = [](double x) { return x / 2; };
+  InverseCdfSampler x = InverseCdfSampler::fromPdf(xPdf, 0, 2, tolerance);
+  XRandom xRandom;
+  printInverseCheck("x", x, [](double x) { return x * x / 4; }, [](double u) { return 2 * std::sqrt(u); }, xRandom,
+                    count);
+}
 
-class XRandom
+// Kolmogorov-Smirnov distance between samples (sorted in place) and a cdf
+double ksDistance(std::vector<double> &samples, const std::function<double(double)> &cdf)
 {
-private:
-  // mean: meu
-  // u = U[0,1]
-  inline double inv_comu_pdf(const double &u)
+  std::sort(samples.begin(), samples.end());
+  double n = samples.size();
+  double distance = 0;
+  for (std::size_t i = 0; i < samples.size(); i++)
   {
-    return 2 * std::sqrt(u);
+    double f = cdf(samples[i]);
+    distance = std::max(distance, std::max(f - i / n, (i + 1) / n - f));
   }
+  return distance;
+}
 
-  std::random_device seed_gen;
-  std::mt19937 engine = std::mt19937(seed_gen());
-  std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0, 1);
+// Times one way of filling samples and reports its KS distance to cdf
+template <typename Fill>
+void printSamplerRun(const std::string &name, std::size_t count, const std::function<double(double)> &cdf, Fill fill)
+{
+  std::vector<double> samples(count);
+  auto begin = std::chrono::steady_clock::now();
+  fill(samples);
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - begin).count();
+  std::cout << "  " << name << ": " << count / seconds << " samples/s, KS distance = " << ksDistance(samples, cdf)
+            << "\n";
+}
 
+// Ziggurat against ExpRandom and std::normal_distribution, and the alias table
+// against std::discrete_distribution on Zipf weights. KS distances of about
+// 1 / sqrt(count) are sampling noise.
+void printZigguratBenchmark(std::size_t count)
+{
+  const double meu = 100;
+  std::mt19937 engine(1);
+  // Every sampler below takes at least 64 bits per draw, so this is their ceiling
+  std::uint64_t sink = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; i++)
+  {
+    sink ^= random64(engine);
+  }
+  auto end = std::chrono::steady_clock::now();
+  volatile std::uint64_t keep = sink;
+  (void)keep;
+  std::cout << "random64 from mt19937: " << count / std::chrono::duration<double>(end - begin).count()
+            << " draws/s\n";
 
-public:
+  auto expCdf = [=](double x) { return -std::expm1(-x / meu); };
+  std::cout << "exponential, meu = " << meu << "\n";
+  ExpRandom expRandom(meu);
+  printSamplerRun("ExpRandom getNext", count, expCdf, [&](std::vector<double> &out) {
+    for (double &x : out)
+    {
+      x = expRandom.getNext();
+    }
+  });
+  printSamplerRun("ExpRandom fill", count, expCdf,
+                  [&](std::vector<double> &out) { expRandom.fill(out.data(), out.size()); });
+  ZigguratExponential zigguratExp(meu);
+  printSamplerRun("ziggurat fill", count, expCdf,
+                  [&](std::vector<double> &out) { zigguratExp.fill(engine, out.data(), out.size()); });
 
+  auto normalCdf = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+  std::cout << "normal\n";
+  std::normal_distribution<double> normal(0, 1);
+  printSamplerRun("std::normal_distribution", count, normalCdf, [&](std::vector<double> &out) {
+    for (double &x : out)
+    {
+      x = normal(engine);
+    }
+  });
+  ZigguratNormal zigguratNormal;
+  printSamplerRun("ziggurat fill", count, normalCdf,
+                  [&](std::vector<double> &out) { zigguratNormal.fill(engine, out.data(), out.size()); });
 
-  double getNext()
+  const std::size_t categories = 1000;
+  std::vector<double> weights(categories);
+  double total = 0;
+  for (std::size_t i = 0; i < categories; i++)
   {
-    return inv_comu_pdf(dist(engine));
+    weights[i] = 1.0 / (i + 1);
+    total += weights[i];
   }
-};
+  auto printDiscrete = [&](const std::string &name, const std::function<void(std::vector<std::size_t> &)> &fill) {
+    std::vector<std::size_t> samples(count);
+    auto begin = std::chrono::steady_clock::now();
+    fill(samples);
+    auto end = std::chrono::steady_clock::now();
+    std::vector<double> frequency(categories, 0);
+    for (std::size_t k : samples)
+    {
+      frequency[k] += 1.0 / count;
+    }
+    double distance = 0;
+    for (std::size_t i = 0; i < categories; i++)
+    {
+      distance += std::abs(frequency[i] - weights[i] / total) / 2;
+    }
+    std::cout << "  " << name << ": " << count / std::chrono::duration<double>(end - begin).count()
+              << " samples/s, total variation = " << distance << "\n";
+  };
+  std::cout << "zipf over " << categories << " categories\n";
+  std::discrete_distribution<std::size_t> discrete(weights.begin(), weights.end());
+  printDiscrete("std::discrete_distribution", [&](std::vector<std::size_t> &out) {
+    for (std::size_t &k : out)
+    {
+      k = discrete(engine);
+    }
+  });
+  AliasTable alias(weights);
+  printDiscrete("alias fill", [&](std::vector<std::size_t> &out) { alias.fill(engine, out.data(), out.size()); });
+}
+
+// ExpRandom and XRandom with their uniforms from mt19937 and from
+// one-dimensional Sobol and scrambled Halton engines, through getNext(engine)
+// and fill(engine, ...). Every sample inverts one coordinate, so for a power
+// of two count the first count points are stratified and the KS distance is
+// at most about 1 / count, against about 1 / sqrt(count) for mt19937.
+bool printQuasiRandomCheck(std::size_t count)
+{
+  const double meu = 100;
+  auto expCdf = [=](double x) { return -std::expm1(-x / meu); };
+  auto xCdf = [](double x) { return x * x / 4; };
+  ExpRandom expRandom(meu);
+  XRandom xRandom;
+  bool passed = true;
 
-int main()
+  auto report = [&](const std::string &name, std::vector<double> &samples, const std::function<double(double)> &cdf,
+                    double bound) {
+    double distance = ksDistance(samples, cdf);
+    passed = passed && distance <= bound;
+    std::cout << "  " << name << ": KS distance = " << distance << (distance <= bound ? " ok" : " FAILED") << "\n";
+  };
+  auto run = [&](const std::string &source, double bound, auto makeEngine) {
+    std::cout << source << ", bound " << bound << "\n";
+    std::vector<double> samples(count);
+    auto engine = makeEngine();
+    for (double &x : samples)
+    {
+      x = expRandom.getNext(engine);
+    }
+    report("ExpRandom getNext", samples, expCdf, bound);
+    engine = makeEngine();
+    expRandom.fill(engine, samples.data(), samples.size());
+    report("ExpRandom fill", samples, expCdf, bound);
+    engine = makeEngine();
+    for (double &x : samples)
+    {
+      x = xRandom.getNext(engine);
+    }
+    report("XRandom getNext", samples, xCdf, bound);
+    engine = makeEngine();
+    xRandom.fill(engine, samples.data(), samples.size());
+    report("XRandom fill", samples, xCdf, bound);
+  };
+
+  run("mt19937", 2 / std::sqrt(static_cast<double>(count)), [] { return std::mt19937(1); });
+  run("sobol", 2.0 / count, [] { return QuasiRandomEngine<SobolSequence>(SobolSequence(1)); });
+  run("sobol, scrambled", 2.0 / count, [] { return QuasiRandomEngine<SobolSequence>(SobolSequence(1, 7)); });
+  run("halton, scrambled", 2.0 / count, [] { return QuasiRandomEngine<HaltonSequence>(HaltonSequence(1, 7)); });
+  return passed;
+}
+
+// inverse_sampling
+// inverse_sampling bench [count] [meu]
+// inverse_sampling inverse [count] [tolerance]
+// inverse_sampling ziggurat [count]
+// inverse_sampling qmc [count]
+int main(int argc, char **argv)
 {
+  if (argc > 1 && std::string(argv[1]) == "bench")
+  {
+    printBatchBenchmark(argc > 2 ? std::stoull(argv[2]) : 10000000, argc > 3 ? std::stod(argv[3]) : 100);
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "ziggurat")
+  {
+    printZigguratBenchmark(argc > 2 ? std::stoull(argv[2]) : 1000000);
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "qmc")
+  {
+    return printQuasiRandomCheck(argc > 2 ? std::stoull(argv[2]) : 65536) ? 0 : 1;
+  }
+  if (argc > 1 && std::string(argv[1]) == "inverse")
+  {
+    try
+    {
+      printInverseCdfCheck(argc > 2 ? std::stoull(argv[2]) : 10000000, argc > 3 ? std::stod(argv[3]) : 1e-10);
+    }
+    catch (const std::invalid_argument &e)
+    {
+      std::cerr << e.what() << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
 //  std::ofstream optFileDouble("result_double.txt");
   std::ofstream fout("result_x.txt");
 
@@ -73,4 +350,4 @@ int main()
   }
 
   fout.close();
-}
\ No newline at end of file
+}
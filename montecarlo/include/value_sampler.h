@@ -15,6 +15,14 @@ public:
   {
     return dist_(engine_);
   }
+
+  // Draws from the given uniform random bit generator instead, e.g. a
+  // QuasiRandomEngine from low_discrepancy.h
+  template <typename Engine>
+  double sample(Engine &engine) const
+  {
+    return dist_(engine);
+  }
 };
 
 template <>
@@ -32,4 +40,12 @@ public:
   {
     return dist_(engine_);
   }
+
+  // Draws from the given uniform random bit generator instead, e.g. a
+  // QuasiRandomEngine from low_discrepancy.h
+  template <typename Engine>
+  double sample(Engine &engine) const
+  {
+    return dist_(engine);
+  }
 };
@@ -2,7 +2,10 @@
 #include <cmath>
 #include <random>
 #include <fstream>
+#include <string>
+#include <vector>
 
+#include "low_discrepancy.h"
 #include "value_sampler.h"
 
 class MCTester
@@ -95,11 +98,91 @@ public:
       std::cout << x << " " << y << " " << z << "\n";
     }
   }
+
+  // Sobol's g-function prod (|4x_i - 2| + i) / (1 + i) over [0, 1]^dimensions, whose
+  // integral is 1, with points [begin, end) of the engine's sequence
+  template <typename Engine>
+  double g_function_sum(Engine &engine, int dimensions, std::uint64_t begin, std::uint64_t end)
+  {
+    double sum = 0;
+    for (std::uint64_t n = begin; n < end; n++)
+    {
+      double f = 1;
+      for (int i = 1; i <= dimensions; i++)
+      {
+        f *= (std::abs(4 * sampler01.sample(engine) - 2) + i) / (1 + i);
+      }
+      sum += f;
+    }
+    return sum;
+  }
+
+  // Error of the g-function integral with N points from mt19937 and from each
+  // low-discrepancy sequence; randomized rows are the RMS error over 8 seeds
+  void quasi_random_integral(int dimensions)
+  {
+    constexpr int Seeds = 8;
+    std::cout << "dimensions = " << dimensions << "\n";
+    std::cout << "N mt19937 sobol sobol+owen halton halton+owen r2 r2+shift\n";
+    for (std::uint64_t count = 1 << 8; count <= (1 << 20); count <<= 4)
+    {
+      auto error = [&](auto make, bool randomized) {
+        double squared = 0;
+        int runs = randomized ? Seeds : 1;
+        for (int seed = 1; seed <= runs; seed++)
+        {
+          auto engine = make(randomized ? seed : 0);
+          double e = g_function_sum(engine, dimensions, 0, count) / count - 1;
+          squared += e * e;
+        }
+        return std::sqrt(squared / runs);
+      };
+      auto mt = [](std::uint64_t seed) { return std::mt19937_64(seed + 1); };
+      auto sobol = [&](std::uint64_t seed) {
+        return QuasiRandomEngine<SobolSequence>(SobolSequence(dimensions, seed));
+      };
+      auto halton = [&](std::uint64_t seed) {
+        return QuasiRandomEngine<HaltonSequence>(HaltonSequence(dimensions, seed));
+      };
+      auto r2 = [&](std::uint64_t seed) { return QuasiRandomEngine<R2Sequence>(R2Sequence(dimensions, seed)); };
+      std::cout << count << " " << error(mt, true) << " " << error(sobol, false) << " " << error(sobol, true) << " "
+                << error(halton, false) << " " << error(halton, true) << " " << error(r2, false) << " "
+                << error(r2, true) << "\n";
+    }
+
+    // Four disjoint slices, as four threads would take them, add up to the same sum
+    constexpr std::uint64_t Count = 1 << 16;
+    QuasiRandomEngine<SobolSequence> whole(SobolSequence(dimensions, 1));
+    double single = g_function_sum(whole, dimensions, 0, Count);
+    double sliced = 0;
+    for (std::uint64_t t = 0; t < 4; t++)
+    {
+      QuasiRandomEngine<SobolSequence> slice(SobolSequence(dimensions, 1));
+      slice.seek(Count * t / 4);
+      sliced += g_function_sum(slice, dimensions, Count * t / 4, Count * (t + 1) / 4);
+    }
+    std::cout << "sobol+owen, " << Count << " points in one pass: " << single / Count - 1
+              << ", in 4 slices: " << sliced / Count - 1 << "\n";
+  }
 };
 
-int main()
+// montecarlo
+// montecarlo qmc [dimensions]
+int main(int argc, char **argv)
 {
   MCTester tester;
+  if (argc > 1 && std::string(argv[1]) == "qmc")
+  {
+    // Every sequence of the table must support the dimension, Sobol the fewest
+    int dimensions = argc > 2 ? std::stoi(argv[2]) : 4;
+    if (dimensions < 1 || dimensions > SOBOL_MAX_DIMENSIONS)
+    {
+      std::cerr << "qmc: dimensions must be 1 to " << SOBOL_MAX_DIMENSIONS << "\n";
+      return 1;
+    }
+    tester.quasi_random_integral(dimensions);
+    return 0;
+  }
   //  tester.regular_pi();
   tester.importance_sampling_xyz();
 }
\ No newline at end of file
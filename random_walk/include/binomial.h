@@ -0,0 +1,216 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Largest n sampled from a precomputed table; above it BTPE or inversion
+constexpr int BINOMIAL_TABLE_MAX_N = 1 << 16;
+
+// Uniform double in [0, 1) from the top 53 bits of a 64-bit engine
+template <typename Engine>
+double uniform01(Engine &engine) {
+  return static_cast<double>(engine() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// P(Binomial(n, p) = k)
+inline double binomialPmf(int n, int k, double p) {
+  if (k < 0 || k > n) return 0;
+  if (p <= 0) return k == 0 ? 1 : 0;
+  if (p >= 1) return k == n ? 1 : 0;
+  return std::exp(std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0) + k * std::log(p) +
+                  (n - k) * std::log1p(-p));
+}
+
+// Inverse-CDF sampler over 0..size-1 with a guide table: guide_[i] is the
+// first index whose CDF exceeds i/size, so a draw starts next to its answer
+// and needs about one comparison
+class TableSampler {
+ public:
+  TableSampler() = default;
+
+  explicit TableSampler(const std::vector<double> &pmf) : cdf_(pmf.size()), guide_(pmf.size()) {
+    double sum = 0;
+    for (std::size_t k = 0; k < pmf.size(); k++) {
+      sum += pmf[k];
+      cdf_[k] = sum;
+    }
+    for (double &c : cdf_) c /= sum;
+    cdf_.back() = 1;  // u < 1 always stops at the last entry
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < guide_.size(); i++) {
+      while (cdf_[k] <= static_cast<double>(i) / guide_.size()) k++;
+      guide_[i] = static_cast<int>(k);
+    }
+  }
+
+  template <typename Engine>
+  int operator()(Engine &engine) const {
+    double u = uniform01(engine);
+    int k = guide_[static_cast<std::size_t>(u * guide_.size())];
+    while (cdf_[k] <= u) k++;
+    return k;
+  }
+
+ private:
+  std::vector<double> cdf_;
+  std::vector<int> guide_;
+};
+
+// Exact Binomial(n, p) sampler. n up to BINOMIAL_TABLE_MAX_N uses a table;
+// larger n uses BTPE (Kachitvichyanukul and Schmeiser) when n*min(p, 1-p) >= 30
+// and sequential inversion below that, where the expected search is short.
+class BinomialSampler {
+ public:
+  BinomialSampler(int n, double p) : n_(n), p_(p) {
+    if (p <= 0 || p >= 1 || n == 0) return;
+    if (n <= BINOMIAL_TABLE_MAX_N) {
+      std::vector<double> pmf(n + 1);
+      for (int k = 0; k <= n; k++) pmf[k] = binomialPmf(n, k, p);
+      table_ = TableSampler(pmf);
+      method_ = Method::Table;
+      return;
+    }
+    r_ = std::min(p, 1 - p);
+    q_ = 1 - r_;
+    if (n * r_ < 30) {
+      qn_ = std::exp(n * std::log(q_));
+      bound_ = std::min(static_cast<double>(n), n * r_ + 10 * std::sqrt(n * r_ * q_ + 1));
+      method_ = Method::Inversion;
+      return;
+    }
+    double fm = n * r_ + r_;
+    m_ = static_cast<long long>(std::floor(fm));
+    p1_ = std::floor(2.195 * std::sqrt(n * r_ * q_) - 4.6 * q_) + 0.5;
+    xm_ = m_ + 0.5;
+    xl_ = xm_ - p1_;
+    xr_ = xm_ + p1_;
+    c_ = 0.134 + 20.5 / (15.3 + m_);
+    double a = (fm - xl_) / (fm - xl_ * r_);
+    laml_ = a * (1 + a / 2);
+    a = (xr_ - fm) / (xr_ * q_);
+    lamr_ = a * (1 + a / 2);
+    p2_ = p1_ * (1 + 2 * c_);
+    p3_ = p2_ + c_ / laml_;
+    p4_ = p3_ + c_ / lamr_;
+    method_ = Method::Btpe;
+  }
+
+  template <typename Engine>
+  int operator()(Engine &engine) const {
+    switch (method_) {
+      case Method::Table:
+        return table_(engine);
+      case Method::Inversion:
+        return p_ > 0.5 ? n_ - inversion(engine) : inversion(engine);
+      case Method::Btpe:
+        return p_ > 0.5 ? n_ - btpe(engine) : btpe(engine);
+      default:
+        return p_ >= 1 ? n_ : 0;
+    }
+  }
+
+ private:
+  enum class Method { Constant, Table, Inversion, Btpe };
+
+  // Walks the pmf up from 0; restarts past a bound that is exceeded with
+  // negligible probability, which keeps rounding from running away
+  template <typename Engine>
+  int inversion(Engine &engine) const {
+    int x = 0;
+    double px = qn_;
+    double u = uniform01(engine);
+    while (u > px) {
+      x++;
+      if (x > bound_) {
+        x = 0;
+        px = qn_;
+        u = uniform01(engine);
+      } else {
+        u -= px;
+        px = ((n_ - x + 1) * r_ * px) / (x * q_);
+      }
+    }
+    return x;
+  }
+
+  // BTPE for min(p, 1-p) = r_: a triangle, two parallelograms and two
+  // exponential tails majorize the pmf; most draws end in the triangle
+  template <typename Engine>
+  int btpe(Engine &engine) const {
+    double nrq = n_ * r_ * q_;
+    while (true) {
+      double u = uniform01(engine) * p4_;
+      double v = uniform01(engine);
+      long long y;
+      if (u <= p1_) {
+        return static_cast<int>(std::floor(xm_ - p1_ * v + u));
+      }
+      if (u <= p2_) {
+        double x = xl_ + (u - p1_) / c_;
+        v = v * c_ + 1 - std::fabs(m_ - x + 0.5) / p1_;
+        if (v > 1) continue;
+        y = static_cast<long long>(std::floor(x));
+      } else if (u <= p3_) {
+        if (v == 0) continue;
+        y = static_cast<long long>(std::floor(xl_ + std::log(v) / laml_));
+        if (y < 0) continue;
+        v = v * (u - p2_) * laml_;
+      } else {
+        if (v == 0) continue;
+        y = static_cast<long long>(std::floor(xr_ - std::log(v) / lamr_));
+        if (y > n_) continue;
+        v = v * (u - p3_) * lamr_;
+      }
+
+      long long k = std::llabs(y - m_);
+      if (k <= 20 || k >= nrq / 2 - 1) {
+        // Explicit pmf ratio f(y) / f(m)
+        double s = r_ / q_;
+        double a = s * (n_ + 1);
+        double f = 1;
+        if (m_ < y) {
+          for (long long i = m_ + 1; i <= y; i++) f *= a / i - s;
+        } else if (m_ > y) {
+          for (long long i = y + 1; i <= m_; i++) f /= a / i - s;
+        }
+        if (v > f) continue;
+        return static_cast<int>(y);
+      }
+
+      // Squeeze, then the Stirling-based bound on log f(y) / f(m)
+      double rho = (k / nrq) * ((k * (k / 3.0 + 0.625) + 1.0 / 6) / nrq + 0.5);
+      double t = -static_cast<double>(k) * k / (2 * nrq);
+      double logV = std::log(v);
+      if (logV < t - rho) return static_cast<int>(y);
+      if (logV > t + rho) continue;
+
+      double x1 = y + 1.0;
+      double f1 = m_ + 1.0;
+      double z = n_ + 1.0 - m_;
+      double w = n_ - y + 1.0;
+      double x2 = x1 * x1;
+      double f2 = f1 * f1;
+      double z2 = z * z;
+      double w2 = w * w;
+      double bound = xm_ * std::log(f1 / x1) + (n_ - m_ + 0.5) * std::log(z / w) +
+                     (y - m_) * std::log(w * r_ / (x1 * q_)) +
+                     (13680. - (462. - (132. - (99. - 140. / f2) / f2) / f2) / f2) / f1 / 166320. +
+                     (13680. - (462. - (132. - (99. - 140. / z2) / z2) / z2) / z2) / z / 166320. +
+                     (13680. - (462. - (132. - (99. - 140. / x2) / x2) / x2) / x2) / x1 / 166320. +
+                     (13680. - (462. - (132. - (99. - 140. / w2) / w2) / w2) / w2) / w / 166320.;
+      if (logV > bound) continue;
+      return static_cast<int>(y);
+    }
+  }
+
+  int n_;
+  double p_;
+  Method method_ = Method::Constant;
+  TableSampler table_;
+  double r_ = 0, q_ = 0;
+  double qn_ = 0, bound_ = 0;
+  long long m_ = 0;
+  double p1_ = 0, p2_ = 0, p3_ = 0, p4_ = 0;
+  double xm_ = 0, xl_ = 0, xr_ = 0, c_ = 0, laml_ = 0, lamr_ = 0;
+};
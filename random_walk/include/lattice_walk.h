@@ -0,0 +1,218 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "walk_engine.h"
+
+// Walkers advanced together; their state and increments stay in cache
+constexpr int LATTICE_WALK_BLOCK = 1024;
+constexpr int LATTICE_WALK_MAX_DIMENSIONS = 3;
+
+enum class WalkBoundary {
+  Free,        // no walls; only cells inside the box are counted
+  Absorbing,   // a walker stops for good on reaching a wall
+  Reflecting,  // a step past a wall is mirrored back into the box
+};
+
+enum class WalkSpace {
+  Lattice,     // one +-1 step along one axis per step
+  Continuous,  // Gaussian step on every axis
+};
+
+// Walks in the box [-bound, bound]^dimensions
+struct LatticeWalkConfig {
+  int dimensions = 2;  // 1 to LATTICE_WALK_MAX_DIMENSIONS
+  long long walkers = 100000;
+  int steps = 1000;
+  int bound = 32;
+  WalkBoundary boundary = WalkBoundary::Reflecting;
+  WalkSpace space = WalkSpace::Lattice;
+  double sigma = 1;        // standard deviation per axis of a continuous step
+  int threads = 0;         // 0: one per hardware thread
+  std::uint64_t seed = 0;  // 0: drawn once from std::random_device
+};
+
+struct LatticeWalkResult {
+  int dimensions = 0;
+  int bound = 0;
+  long long walkers = 0;
+  long long absorbed = 0;
+  double meanSquaredDistance = 0;  // of the final positions
+  // Walker-steps spent in each cell, axis 0 fastest; cells are the lattice
+  // points, continuous positions are rounded to the nearest one
+  std::vector<long long> occupancy;
+
+  int width() const { return 2 * bound + 1; }
+};
+
+// State of one block of walkers as structure of arrays: x_[d][i] is the
+// coordinate of walker i on axis d, and active_[i] is 1 until it is absorbed.
+// Every pass is a straight loop over one array with the boundary applied by
+// min/max and multiplication, so the compiler can vectorize it.
+class WalkerBlock {
+ public:
+  WalkerBlock(const LatticeWalkConfig &config, int size) : config_(config), size_(size), active_(size, 1) {
+    for (int d = 0; d < config.dimensions; d++) {
+      x_[d].assign(size, 0);
+      dx_[d].assign(size, 0);
+    }
+    cell_.assign(size, 0);
+  }
+
+  void step(WalkRandom &engine, std::normal_distribution<double> &normal) {
+    drawIncrements(engine, normal);
+    const double *active = active_.data();
+    for (int d = 0; d < config_.dimensions; d++) {
+      double *x = x_[d].data();
+      const double *dx = dx_[d].data();
+      for (int i = 0; i < size_; i++) x[i] += active[i] * dx[i];
+    }
+    applyBoundary();
+  }
+
+  // Adds every walker to the cell it occupies
+  void countOccupancy(std::vector<long long> &occupancy) {
+    int bound = config_.bound;
+    int width = 2 * bound + 1;
+    double *weight = dx_[0].data();  // reused as scratch once the step is applied
+    for (int i = 0; i < size_; i++) {
+      cell_[i] = 0;
+      weight[i] = config_.boundary == WalkBoundary::Absorbing ? active_[i] : 1;
+    }
+    int stride = 1;
+    for (int d = 0; d < config_.dimensions; d++) {
+      const double *x = x_[d].data();
+      for (int i = 0; i < size_; i++) {
+        double c = std::floor(x[i] + 0.5);
+        weight[i] *= std::fabs(c) <= bound;
+        cell_[i] += stride * static_cast<int>(std::min<double>(std::max<double>(c, -bound), bound) + bound);
+      }
+      stride *= width;
+    }
+    for (int i = 0; i < size_; i++) occupancy[cell_[i]] += static_cast<long long>(weight[i]);
+  }
+
+  double activeCount() const {
+    double sum = 0;
+    for (int i = 0; i < size_; i++) sum += active_[i];
+    return sum;
+  }
+
+  double squaredDistanceSum() const {
+    double sum = 0;
+    for (int d = 0; d < config_.dimensions; d++) {
+      for (int i = 0; i < size_; i++) sum += x_[d][i] * x_[d][i];
+    }
+    return sum;
+  }
+
+ private:
+  void drawIncrements(WalkRandom &engine, std::normal_distribution<double> &normal) {
+    if (config_.space == WalkSpace::Continuous) {
+      for (int d = 0; d < config_.dimensions; d++) {
+        for (int i = 0; i < size_; i++) dx_[d][i] = config_.sigma * normal(engine);
+      }
+      return;
+    }
+    // One of 2 * dimensions directions from 32 random bits each
+    std::uint64_t directions = 2 * config_.dimensions;
+    for (int i = 0; i < size_; i += 2) {
+      std::uint64_t bits = engine();
+      for (int j = 0; j < 2 && i + j < size_; j++) {
+        std::uint64_t r = ((bits >> (32 * j)) & 0xffffffffULL) * directions >> 32;
+        int axis = static_cast<int>(r >> 1);
+        double sign = 1 - 2.0 * (r & 1);
+        for (int d = 0; d < config_.dimensions; d++) dx_[d][i + j] = sign * (d == axis);
+      }
+    }
+  }
+
+  void applyBoundary() {
+    double bound = config_.bound;
+    if (config_.boundary == WalkBoundary::Reflecting) {
+      for (int d = 0; d < config_.dimensions; d++) {
+        double *x = x_[d].data();
+        for (int i = 0; i < size_; i++) {
+          double y = std::min(x[i], 2 * bound - x[i]);
+          y = std::max(y, -2 * bound - y);
+          // Steps longer than the box are clamped to the wall
+          x[i] = std::min(std::max(y, -bound), bound);
+        }
+      }
+    } else if (config_.boundary == WalkBoundary::Absorbing) {
+      double *active = active_.data();
+      for (int d = 0; d < config_.dimensions; d++) {
+        double *x = x_[d].data();
+        for (int i = 0; i < size_; i++) {
+          active[i] *= std::fabs(x[i]) < bound;
+          x[i] = std::min(std::max(x[i], -bound), bound);
+        }
+      }
+    }
+  }
+
+  const LatticeWalkConfig &config_;
+  int size_;
+  std::array<std::vector<double>, LATTICE_WALK_MAX_DIMENSIONS> x_;
+  std::array<std::vector<double>, LATTICE_WALK_MAX_DIMENSIONS> dx_;
+  std::vector<double> active_;
+  std::vector<int> cell_;
+};
+
+// Runs the walkers block by block on every thread; each thread accumulates its
+// own occupancy grid, and the grids are summed at the end
+inline LatticeWalkResult runLatticeWalks(const LatticeWalkConfig &config) {
+  int threads = walkThreadCount(config.threads);
+  std::uint64_t seed = config.seed;
+  if (seed == 0) {
+    std::random_device seed_gen;
+    seed = (static_cast<std::uint64_t>(seed_gen()) << 32) | seed_gen();
+  }
+  long long cells = 1;
+  for (int d = 0; d < config.dimensions; d++) cells *= 2 * config.bound + 1;
+
+  std::vector<std::vector<long long>> occupancy(threads, std::vector<long long>(cells, 0));
+  std::vector<double> active(threads, 0);
+  std::vector<double> squared(threads, 0);
+  auto work = [&](int t) {
+    WalkRandom engine = makeWalkStream(seed, t);
+    std::normal_distribution<double> normal(0, 1);
+    long long begin = config.walkers * t / threads;
+    long long end = config.walkers * (t + 1) / threads;
+    for (long long first = begin; first < end; first += LATTICE_WALK_BLOCK) {
+      WalkerBlock block(config, static_cast<int>(std::min<long long>(LATTICE_WALK_BLOCK, end - first)));
+      for (int s = 0; s < config.steps; s++) {
+        block.step(engine, normal);
+        block.countOccupancy(occupancy[t]);
+      }
+      active[t] += block.activeCount();
+      squared[t] += block.squaredDistanceSum();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++) workers.emplace_back(work, t);
+  work(0);
+  for (std::thread &worker : workers) worker.join();
+
+  LatticeWalkResult result;
+  result.dimensions = config.dimensions;
+  result.bound = config.bound;
+  result.walkers = config.walkers;
+  result.occupancy.assign(cells, 0);
+  double activeSum = 0;
+  double squaredSum = 0;
+  for (int t = 0; t < threads; t++) {
+    for (long long c = 0; c < cells; c++) result.occupancy[c] += occupancy[t][c];
+    activeSum += active[t];
+    squaredSum += squared[t];
+  }
+  result.absorbed = config.walkers - static_cast<long long>(activeSum);
+  result.meanSquaredDistance = config.walkers > 0 ? squaredSum / config.walkers : 0;
+  return result;
+}
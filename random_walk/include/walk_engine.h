@@ -0,0 +1,189 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "binomial.h"
+
+// How the steps of one walk are drawn
+enum class WalkStepping {
+  Scalar,       // one uniform double per step
+  BitParallel,  // 64 steps per Bernoulli mask and popcount
+  Binomial,     // endpoint only, drawn exactly as 2 * Binomial(n, p) - n
+};
+
+// One batch of 1D +-1 walks
+struct WalkConfig {
+  long long walkers = 100000;
+  int steps = 100;
+  double posP = 0.5;       // positive probability
+  int threads = 0;         // 0: one per hardware thread
+  std::uint64_t seed = 0;  // 0: drawn once from std::random_device
+  WalkStepping stepping = WalkStepping::BitParallel;
+};
+
+// Online mean and variance (Welford); two partial results merge exactly
+// (Chan et al.), so every thread keeps its own and they are combined at the end
+struct RunningMoments {
+  long long count = 0;
+  double mean = 0;
+  double m2 = 0;  // sum of squared deviations from the mean
+
+  void add(double x) {
+    count++;
+    double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+  }
+
+  void merge(const RunningMoments &other) {
+    if (other.count == 0) return;
+    long long total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    count = total;
+  }
+
+  double variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+};
+
+// Endpoint histogram of a batch: counts[k] walkers made k positive steps and
+// ended at position 2k - steps
+struct WalkResult {
+  int steps = 0;
+  long long walkers = 0;
+  std::vector<long long> counts;
+  RunningMoments moments;  // of the endpoints, accumulated while walking
+
+  int position(int k) const { return 2 * k - steps; }
+  double mean() const { return moments.mean; }
+  double variance() const { return moments.variance(); }
+};
+
+using WalkRandom = std::mt19937_64;
+
+// Independent stream `index` of a batch, seeded once per thread
+inline WalkRandom makeWalkStream(std::uint64_t seed, int index) {
+  std::seed_seq seq{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                    static_cast<std::uint32_t>(index)};
+  return WalkRandom(seq);
+}
+
+// Number of positive steps of one walk
+inline int walkPositiveSteps(WalkRandom &engine, std::uniform_real_distribution<double> &dist, int steps,
+                             double posP) {
+  int positive = 0;
+  for (int i = 0; i < steps; i++) {
+    if (dist(engine) < posP) positive++;
+  }
+  return positive;
+}
+
+// 64 independent Bernoulli(p) bits per call. Every lane compares a uniform
+// number, drawn one bit per random word, against the binary expansion of p
+// (64 bits of it) and is decided at the first bit where the two differ. All
+// lanes are decided after about log2(64) + 2 words, and p = 0.5 takes exactly
+// one word since its expansion ends after the first bit.
+class BernoulliBits {
+ public:
+  explicit BernoulliBits(double p) {
+    if (p >= 1) {
+      all_ = true;
+    } else if (p > 0) {
+      threshold_ = static_cast<std::uint64_t>(std::ldexp(p, 64));
+    }
+    lowest_ = threshold_ != 0 ? __builtin_ctzll(threshold_) : 64;
+  }
+
+  std::uint64_t next(WalkRandom &engine) const {
+    if (all_) return ~0ULL;
+    std::uint64_t result = 0;
+    std::uint64_t undecided = ~0ULL;
+    // Past the lowest set bit of p every undecided lane would lose
+    for (int i = 63; i >= lowest_ && undecided != 0; i--) {
+      std::uint64_t u = engine();
+      if (threshold_ >> i & 1) {
+        result |= undecided & ~u;
+        undecided &= u;
+      } else {
+        undecided &= ~u;
+      }
+    }
+    return result;
+  }
+
+ private:
+  std::uint64_t threshold_ = 0;  // p as a 0.64 fixed-point fraction
+  int lowest_ = 64;
+  bool all_ = false;
+};
+
+// Number of positive steps of one walk, 64 steps per mask
+inline int walkPositiveSteps(WalkRandom &engine, const BernoulliBits &bits, int steps) {
+  int positive = 0;
+  for (; steps >= 64; steps -= 64) positive += __builtin_popcountll(bits.next(engine));
+  if (steps > 0) positive += __builtin_popcountll(bits.next(engine) & ((1ULL << steps) - 1));
+  return positive;
+}
+
+inline int walkThreadCount(int threads) {
+  if (threads > 0) return threads;
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Runs config.walkers walks split evenly over the threads. Each thread owns its
+// PRNG stream, its histogram and its moments, so nothing is shared until the
+// final merge and memory does not grow with the number of walkers.
+inline WalkResult runWalks(const WalkConfig &config) {
+  int threads = walkThreadCount(config.threads);
+  std::uint64_t seed = config.seed;
+  if (seed == 0) {
+    std::random_device seed_gen;
+    seed = (static_cast<std::uint64_t>(seed_gen()) << 32) | seed_gen();
+  }
+
+  std::vector<std::vector<long long>> counts(threads, std::vector<long long>(config.steps + 1, 0));
+  std::vector<RunningMoments> moments(threads);
+  auto work = [&](int t) {
+    WalkRandom engine = makeWalkStream(seed, t);
+    std::uniform_real_distribution<double> dist(0, 1);
+    BernoulliBits bits(config.posP);
+    BinomialSampler binomial(config.stepping == WalkStepping::Binomial ? config.steps : 0, config.posP);
+    long long begin = config.walkers * t / threads;
+    long long end = config.walkers * (t + 1) / threads;
+    std::vector<long long> &local = counts[t];
+    RunningMoments localMoments;
+    for (long long w = begin; w < end; w++) {
+      int positive;
+      if (config.stepping == WalkStepping::Binomial) {
+        positive = binomial(engine);
+      } else if (config.stepping == WalkStepping::BitParallel) {
+        positive = walkPositiveSteps(engine, bits, config.steps);
+      } else {
+        positive = walkPositiveSteps(engine, dist, config.steps, config.posP);
+      }
+      local[positive]++;
+      localMoments.add(2 * positive - config.steps);
+    }
+    moments[t] = localMoments;
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++) workers.emplace_back(work, t);
+  work(0);
+  for (std::thread &worker : workers) worker.join();
+
+  WalkResult result;
+  result.steps = config.steps;
+  result.walkers = config.walkers;
+  result.counts.assign(config.steps + 1, 0);
+  for (int t = 0; t < threads; t++) {
+    for (int k = 0; k <= config.steps; k++) result.counts[k] += counts[t][k];
+    result.moments.merge(moments[t]);
+  }
+  return result;
+}
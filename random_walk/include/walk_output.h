@@ -0,0 +1,234 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lattice_walk.h"
+#include "walk_engine.h"
+
+// Named columns of int64 or float64 values, written one column after another.
+// Binary layout, all little-endian:
+//   "RWC1", uint32 column count, then per column
+//   uint8 type (0 int64, 1 float64), uint8 role (0 data, 1 parameter),
+//   uint32 name length, name, uint64 row count, rows
+// Parameter columns hold one run parameter each, next to the data columns.
+class ColumnTable {
+ public:
+  enum class Type : std::uint8_t { Int64 = 0, Float64 = 1 };
+  enum class Role : std::uint8_t { Data = 0, Parameter = 1 };
+
+  struct Column {
+    std::string name;
+    Type type;
+    Role role;
+    std::vector<std::int64_t> ints;
+    std::vector<double> reals;
+
+    std::size_t size() const { return type == Type::Int64 ? ints.size() : reals.size(); }
+  };
+
+  void add(const std::string &name, std::vector<std::int64_t> values) {
+    columns_.push_back(Column{name, Type::Int64, Role::Data, std::move(values), {}});
+  }
+
+  void add(const std::string &name, std::vector<double> values) {
+    columns_.push_back(Column{name, Type::Float64, Role::Data, {}, std::move(values)});
+  }
+
+  void addParameter(const std::string &name, std::int64_t value) {
+    columns_.push_back(Column{name, Type::Int64, Role::Parameter, {value}, {}});
+  }
+
+  void addParameter(const std::string &name, double value) {
+    columns_.push_back(Column{name, Type::Float64, Role::Parameter, {}, {value}});
+  }
+
+  const std::vector<Column> &columns() const { return columns_; }
+
+  // Same names, types, roles and values; reals compare bit for bit, so a NaN
+  // read back equals the NaN written
+  bool operator==(const ColumnTable &other) const {
+    if (columns_.size() != other.columns_.size()) return false;
+    for (std::size_t c = 0; c < columns_.size(); c++) {
+      const Column &a = columns_[c];
+      const Column &b = other.columns_[c];
+      if (a.name != b.name || a.type != b.type || a.role != b.role || a.ints != b.ints ||
+          a.reals.size() != b.reals.size()) {
+        return false;
+      }
+      if (!a.reals.empty() && std::memcmp(a.reals.data(), b.reals.data(), a.reals.size() * sizeof(double)) != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(const ColumnTable &other) const { return !(*this == other); }
+
+  void writeBinary(const std::string &path) const {
+    std::vector<char> bytes(kMagic, kMagic + 4);
+    putLittleEndian(bytes, columns_.size(), 4);
+    for (const Column &column : columns_) {
+      putLittleEndian(bytes, static_cast<std::uint8_t>(column.type), 1);
+      putLittleEndian(bytes, static_cast<std::uint8_t>(column.role), 1);
+      putLittleEndian(bytes, column.name.size(), 4);
+      bytes.insert(bytes.end(), column.name.begin(), column.name.end());
+      putLittleEndian(bytes, column.size(), 8);
+      for (std::int64_t x : column.ints) putLittleEndian(bytes, static_cast<std::uint64_t>(x), 8);
+      for (double x : column.reals) {
+        std::uint64_t raw;
+        std::memcpy(&raw, &x, sizeof(raw));
+        putLittleEndian(bytes, raw, 8);
+      }
+    }
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.write(bytes.data(), bytes.size())) throw std::runtime_error("walk output: cannot write " + path);
+  }
+
+  static ColumnTable readBinary(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::size_t pos = 0;
+    auto take = [&](std::size_t size) {
+      if (bytes.size() - pos < size) throw std::runtime_error("walk output: truncated " + path);
+      std::uint64_t value = 0;
+      for (std::size_t i = 0; i < size; i++) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[pos + i])) << (8 * i);
+      }
+      pos += size;
+      return value;
+    };
+
+    if (bytes.size() < 4 || std::memcmp(bytes.data(), kMagic, 4) != 0) {
+      throw std::runtime_error("walk output: not a column file " + path);
+    }
+    pos = 4;
+    ColumnTable table;
+    std::uint64_t count = take(4);
+    for (std::uint64_t c = 0; c < count; c++) {
+      Column column;
+      std::uint64_t type = take(1);
+      std::uint64_t role = take(1);
+      if (type > 1 || role > 1) throw std::runtime_error("walk output: bad column type in " + path);
+      column.type = static_cast<Type>(type);
+      column.role = static_cast<Role>(role);
+      std::uint64_t nameSize = take(4);
+      if (bytes.size() - pos < nameSize) throw std::runtime_error("walk output: truncated " + path);
+      column.name.assign(bytes.data() + pos, nameSize);
+      pos += nameSize;
+      std::uint64_t rows = take(8);
+      for (std::uint64_t r = 0; r < rows; r++) {
+        std::uint64_t raw = take(8);
+        if (column.type == Type::Int64) {
+          column.ints.push_back(static_cast<std::int64_t>(raw));
+        } else {
+          double x;
+          std::memcpy(&x, &raw, sizeof(x));
+          column.reals.push_back(x);
+        }
+      }
+      table.columns_.push_back(std::move(column));
+    }
+    return table;
+  }
+
+  // Parameter columns as "# name value" lines, then the data columns as a
+  // header line and one line per row; meant for small runs
+  void writeText(const std::string &path) const {
+    std::ofstream ofs(path);
+    ofs.precision(std::numeric_limits<double>::max_digits10);
+    std::vector<const Column *> data;
+    for (const Column &column : columns_) {
+      if (column.role == Role::Parameter) {
+        ofs << "# " << column.name;
+        for (std::size_t r = 0; r < column.size(); r++) {
+          ofs << " ";
+          if (column.type == Type::Int64) {
+            ofs << column.ints[r];
+          } else {
+            ofs << column.reals[r];
+          }
+        }
+        ofs << "\n";
+      } else {
+        data.push_back(&column);
+      }
+    }
+    if (data.empty()) return;
+    for (std::size_t c = 0; c < data.size(); c++) ofs << (c ? " " : "") << data[c]->name;
+    ofs << "\n";
+    for (std::size_t r = 0; r < data[0]->size(); r++) {
+      for (std::size_t c = 0; c < data.size(); c++) {
+        ofs << (c ? " " : "");
+        if (data[c]->type == Type::Int64) {
+          ofs << data[c]->ints[r];
+        } else {
+          ofs << data[c]->reals[r];
+        }
+      }
+      ofs << "\n";
+    }
+    if (!ofs) throw std::runtime_error("walk output: cannot write " + path);
+  }
+
+ private:
+  static constexpr char kMagic[4] = {'R', 'W', 'C', '1'};
+
+  static void putLittleEndian(std::vector<char> &bytes, std::uint64_t value, int size) {
+    for (int i = 0; i < size; i++) bytes.push_back(static_cast<char>(value >> (8 * i)));
+  }
+
+  std::vector<Column> columns_;
+};
+
+// Run parameters and moments, then the non-empty bins as (position, count)
+inline ColumnTable walkResultTable(const WalkConfig &config, const WalkResult &result) {
+  ColumnTable table;
+  table.addParameter("steps", static_cast<std::int64_t>(config.steps));
+  table.addParameter("walkers", static_cast<std::int64_t>(config.walkers));
+  table.addParameter("posP", config.posP);
+  table.addParameter("mean", result.mean());
+  table.addParameter("variance", result.variance());
+  std::vector<std::int64_t> positions, counts;
+  for (int k = 0; k <= result.steps; k++) {
+    if (result.counts[k] == 0) continue;
+    positions.push_back(result.position(k));
+    counts.push_back(result.counts[k]);
+  }
+  table.add("position", std::move(positions));
+  table.add("count", std::move(counts));
+  return table;
+}
+
+// Run parameters, then the visited cells as one coordinate column per axis
+// and their walker-step counts
+inline ColumnTable latticeResultTable(const LatticeWalkConfig &config, const LatticeWalkResult &result) {
+  ColumnTable table;
+  table.addParameter("dimensions", static_cast<std::int64_t>(config.dimensions));
+  table.addParameter("walkers", static_cast<std::int64_t>(config.walkers));
+  table.addParameter("steps", static_cast<std::int64_t>(config.steps));
+  table.addParameter("bound", static_cast<std::int64_t>(config.bound));
+  table.addParameter("absorbed", static_cast<std::int64_t>(result.absorbed));
+  table.addParameter("meanSquaredDistance", result.meanSquaredDistance);
+  std::vector<std::vector<std::int64_t>> coordinates(result.dimensions);
+  std::vector<std::int64_t> counts;
+  int width = result.width();
+  for (std::size_t c = 0; c < result.occupancy.size(); c++) {
+    if (result.occupancy[c] == 0) continue;
+    std::size_t rest = c;
+    for (int d = 0; d < result.dimensions; d++) {
+      coordinates[d].push_back(static_cast<std::int64_t>(rest % width) - result.bound);
+      rest /= width;
+    }
+    counts.push_back(result.occupancy[c]);
+  }
+  const char *axes[] = {"x", "y", "z"};
+  for (int d = 0; d < result.dimensions; d++) table.add(axes[d], std::move(coordinates[d]));
+  table.add("count", std::move(counts));
+  return table;
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "binomial.h"
+
+// Exact distributions of a +-1 walk of n steps from 0 with positive
+// probability p: S_n the endpoint, M_n = max(S_0..S_n) the maximum excursion
+// and T_a the first time the walk reaches a level a > 0.
+class WalkDistribution {
+ public:
+  WalkDistribution(int steps, double posP)
+      : steps_(steps), posP_(posP), endpoint_(steps + 1), prefix_(steps + 2, 0), suffix_(steps + 2, 0) {
+    for (int k = 0; k <= steps; k++) endpoint_[k] = binomialPmf(steps, k, posP);
+    for (int k = 0; k <= steps; k++) prefix_[k + 1] = prefix_[k] + endpoint_[k];
+    for (int k = steps; k >= 0; k--) suffix_[k] = suffix_[k + 1] + endpoint_[k];
+  }
+
+  int steps() const { return steps_; }
+
+  // P(S_n = position)
+  double endpointPmf(int position) const {
+    if ((position + steps_) % 2 != 0 || position < -steps_ || position > steps_) return 0;
+    return endpoint_[(position + steps_) / 2];
+  }
+
+  // P(M_n >= level). By reflection at the first visit to level, a path that
+  // ends at b < level is as likely as the reflected one ending at 2*level - b,
+  // times (q/p)^(level - b), which sums to
+  //   P(M_n >= a) = P(S_n >= a) + (p/q)^a P(S_n < -a).
+  double maxAtLeast(int level) const {
+    if (level <= 0) return 1;
+    if (level > steps_) return 0;
+    if (posP_ <= 0) return 0;
+    // 2k - n >= level and 2k - n < -level in numbers k of positive steps
+    double above = suffix_[(level + steps_ + 1) / 2];
+    double below = prefix_[(steps_ - level + 1) / 2];
+    if (posP_ >= 1 || below == 0) return std::min(1.0, above);
+    return std::min(1.0, above + std::exp(level * std::log(posP_ / (1 - posP_)) + std::log(below)));
+  }
+
+  // P(M_n = level) for level = 0..n
+  std::vector<double> maxPmf() const {
+    std::vector<double> pmf(steps_ + 1);
+    double next = maxAtLeast(0);
+    for (int level = 0; level <= steps_; level++) {
+      double current = next;
+      next = maxAtLeast(level + 1);
+      pmf[level] = std::max(0.0, current - next);
+    }
+    return pmf;
+  }
+
+  // P(T_level = t) = level / t * P(S_t = level), the hitting time theorem
+  double firstPassagePmf(int level, int t) const {
+    if (level <= 0 || t < level || (t - level) % 2 != 0) return 0;
+    return static_cast<double>(level) / t * binomialPmf(t, (t + level) / 2, posP_);
+  }
+
+  // Distribution of T_level for t = 0..n, with index n + 1 for walks that do
+  // not reach level within n steps
+  std::vector<double> firstPassageTable(int level) const {
+    std::vector<double> pmf(steps_ + 2, 0);
+    double reached = 0;
+    for (int t = 1; t <= steps_; t++) {
+      pmf[t] = firstPassagePmf(level, t);
+      reached += pmf[t];
+    }
+    pmf[steps_ + 1] = std::max(0.0, 1 - reached);
+    return pmf;
+  }
+
+ private:
+  int steps_;
+  double posP_;
+  std::vector<double> endpoint_;  // by number of positive steps
+  std::vector<double> prefix_;    // prefix_[k]: sum of endpoint_[0..k-1]
+  std::vector<double> suffix_;    // suffix_[k]: sum of endpoint_[k..n]
+};
+
+// Draws M_n without simulating the path
+class MaxExcursionSampler {
+ public:
+  explicit MaxExcursionSampler(const WalkDistribution &distribution) : table_(distribution.maxPmf()) {}
+
+  template <typename Engine>
+  int operator()(Engine &engine) const {
+    return table_(engine);
+  }
+
+ private:
+  TableSampler table_;
+};
+
+// Draws T_level, or n + 1 for walks that do not reach it within n steps
+class FirstPassageSampler {
+ public:
+  FirstPassageSampler(const WalkDistribution &distribution, int level)
+      : table_(distribution.firstPassageTable(level)) {}
+
+  template <typename Engine>
+  int operator()(Engine &engine) const {
+    return table_(engine);
+  }
+
+ private:
+  TableSampler table_;
+};
+
+// What the step-by-step simulator records of one path
+struct WalkPath {
+  int endpoint = 0;
+  int maximum = 0;
+  int firstPassage = 0;  // steps + 1 when level was never reached
+};
+
+template <typename Engine>
+WalkPath simulateWalkPath(Engine &engine, int steps, double posP, int level) {
+  WalkPath path;
+  path.firstPassage = steps + 1;
+  for (int t = 1; t <= steps; t++) {
+    path.endpoint += uniform01(engine) < posP ? 1 : -1;
+    path.maximum = std::max(path.maximum, path.endpoint);
+    if (path.endpoint == level && path.firstPassage > steps) path.firstPassage = t;
+  }
+  return path;
+}
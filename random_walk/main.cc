@@ -1,29 +1,194 @@
-#include <array>
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <random>
 #include <string>
+#include <vector>
 
-// posP : positive probability
-int randomWalk(int count, double posP = 0.5) {
-  int step = 0;
-  std::random_device seed_gen;
-  std::mt19937 engine(seed_gen());
-  std::uniform_real_distribution<double> dist(0, 1);
-
-  for (int i = 0; i < count; i++) {
-    if (dist(engine) < posP)
-      step++;
-    else
-      step--;
+#include "lattice_walk.h"
+#include "walk_engine.h"
+#include "walk_output.h"
+#include "walk_statistics.h"
+
+// Tables with at most this many rows are written as text unless asked otherwise
+constexpr std::size_t WALK_TEXT_MAX_ROWS = 4096;
+
+// Writes base.bin, base.txt or nothing for format binary, text or none; any
+// other format picks text for small tables and binary for the rest
+void writeTable(const ColumnTable &table, const std::string &base, const std::string &format) {
+  if (format == "none") return;
+  std::size_t rows = 0;
+  for (const ColumnTable::Column &column : table.columns()) rows = std::max(rows, column.size());
+  bool text = format == "text" || (format != "binary" && rows <= WALK_TEXT_MAX_ROWS);
+  if (text) {
+    table.writeText(base + ".txt");
+  } else {
+    table.writeBinary(base + ".bin");
   }
+}
 
-  return step;
+// Total variation distance between counts out of n and a pmf
+double totalVariation(const std::vector<long long> &counts, const std::vector<double> &pmf, long long n) {
+  double sum = 0;
+  for (std::size_t i = 0; i < pmf.size(); i++) sum += std::abs(static_cast<double>(counts[i]) / n - pmf[i]);
+  return sum / 2;
 }
 
-int main() {
-  std::ofstream ofs("randwalk_k100_100000.txt");
-  for (int k = 0; k < 100000; k++) {
-    ofs << randomWalk(100, 2.0/3) << "\n";
+// Writes the tables of a small walk run (one with a single non-empty bin) and
+// of a lattice run as binary files in the temporary directory and reads them
+// back; true when every table comes back unchanged
+bool checkBinaryRoundTrip() {
+  WalkConfig walk;
+  walk.walkers = 1000;
+  walk.threads = 1;
+  walk.seed = 1;
+  LatticeWalkConfig lattice;
+  lattice.walkers = 1000;
+  lattice.steps = 100;
+  lattice.bound = 8;
+  lattice.threads = 1;
+  lattice.seed = 1;
+
+  std::vector<ColumnTable> tables;
+  tables.push_back(walkResultTable(walk, runWalks(walk)));
+  walk.steps = 1;
+  walk.posP = 1;
+  tables.push_back(walkResultTable(walk, runWalks(walk)));
+  tables.push_back(latticeResultTable(lattice, runLatticeWalks(lattice)));
+
+  std::string path = (std::filesystem::temp_directory_path() /
+                      ("random_walk_check_" + std::to_string(std::random_device()()) + ".bin"))
+                         .string();
+  bool passed = true;
+  for (const ColumnTable &table : tables) {
+    table.writeBinary(path);
+    passed = passed && ColumnTable::readBinary(path) == table;
   }
+  std::remove(path.c_str());
+  std::cout << "binary round trip: " << (passed ? "ok" : "FAILED") << "\n";
+  return passed;
+}
+
+// Endpoint, maximum and first passage to level from the step-by-step
+// simulator and from the direct samplers, each against the exact distribution
+void printCrossCheck(long long walkers, int steps, double posP, int level) {
+  WalkDistribution exact(steps, posP);
+  std::vector<double> endpointPmf(steps + 1);
+  for (int k = 0; k <= steps; k++) endpointPmf[k] = exact.endpointPmf(2 * k - steps);
+  std::vector<double> maxPmf = exact.maxPmf();
+  std::vector<double> passagePmf = exact.firstPassageTable(level);
+
+  std::vector<long long> simEndpoint(steps + 1, 0), simMax(steps + 1, 0), simPassage(steps + 2, 0);
+  std::vector<long long> endpoint(steps + 1, 0), maximum(steps + 1, 0), passage(steps + 2, 0);
+
+  WalkRandom engine = makeWalkStream(1, 0);
+  auto begin = std::chrono::steady_clock::now();
+  for (long long w = 0; w < walkers; w++) {
+    WalkPath path = simulateWalkPath(engine, steps, posP, level);
+    simEndpoint[(path.endpoint + steps) / 2]++;
+    simMax[path.maximum]++;
+    simPassage[path.firstPassage]++;
+  }
+  auto simulated = std::chrono::steady_clock::now();
+
+  BinomialSampler binomial(steps, posP);
+  MaxExcursionSampler maxSampler(exact);
+  FirstPassageSampler passageSampler(exact, level);
+  for (long long w = 0; w < walkers; w++) {
+    endpoint[binomial(engine)]++;
+    maximum[maxSampler(engine)]++;
+    passage[passageSampler(engine)]++;
+  }
+  auto sampled = std::chrono::steady_clock::now();
+
+  std::cout << "walkers = " << walkers << ", steps = " << steps << ", p = " << posP << ", level = " << level << "\n";
+  std::cout << "simulator time = " << std::chrono::duration<double, std::milli>(simulated - begin).count()
+            << " ms, samplers time = " << std::chrono::duration<double, std::milli>(sampled - simulated).count()
+            << " ms\n";
+  std::cout << "total variation to exact (simulator / sampler)\n";
+  std::cout << "endpoint: " << totalVariation(simEndpoint, endpointPmf, walkers) << " / "
+            << totalVariation(endpoint, endpointPmf, walkers) << "\n";
+  std::cout << "maximum: " << totalVariation(simMax, maxPmf, walkers) << " / "
+            << totalVariation(maximum, maxPmf, walkers) << "\n";
+  std::cout << "first passage: " << totalVariation(simPassage, passagePmf, walkers) << " / "
+            << totalVariation(passage, passagePmf, walkers) << "\n";
+  std::cout << "P(reach level) exact = " << exact.maxAtLeast(level)
+            << ", simulator = " << 1 - static_cast<double>(simPassage[steps + 1]) / walkers
+            << ", sampler = " << 1 - static_cast<double>(passage[steps + 1]) / walkers << "\n";
+}
+
+// Lattice or continuous walks in a box, with the visited cells of the
+// occupancy grid written as coordinate and count columns
+void printLatticeWalks(const LatticeWalkConfig &config, const std::string &format) {
+  auto begin = std::chrono::steady_clock::now();
+  LatticeWalkResult result = runLatticeWalks(config);
+  auto finish = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(finish - begin).count();
+
+  std::cout << "dimensions = " << config.dimensions << ", walkers = " << config.walkers << ", steps = " << config.steps
+            << ", bound = " << config.bound << ", threads = " << walkThreadCount(config.threads) << "\n";
+  std::cout << "time = " << seconds * 1000 << " ms, " << config.walkers * config.steps / seconds << " steps/s\n";
+  std::cout << "absorbed = " << result.absorbed << ", mean squared distance = " << result.meanSquaredDistance << "\n";
+
+  writeTable(latticeResultTable(config, result),
+             "lattice_d" + std::to_string(config.dimensions) + "_b" + std::to_string(config.bound), format);
+}
+
+// random_walk [walkers] [steps] [posP] [threads] [bits|scalar|binomial] [auto|text|binary|none]
+// random_walk check [walkers] [steps] [posP] [level]
+// random_walk lattice [dimensions] [walkers] [steps] [bound] [free|absorbing|reflecting] [lattice|continuous]
+//                     [auto|text|binary|none]
+int main(int argc, char **argv) {
+  if (argc > 1 && std::string(argv[1]) == "lattice") {
+    LatticeWalkConfig config;
+    config.dimensions = std::min(std::max(argc > 2 ? std::stoi(argv[2]) : 2, 1), LATTICE_WALK_MAX_DIMENSIONS);
+    config.walkers = argc > 3 ? std::stoll(argv[3]) : 100000;
+    config.steps = argc > 4 ? std::stoi(argv[4]) : 1000;
+    config.bound = argc > 5 ? std::stoi(argv[5]) : 32;
+    std::string boundary = argc > 6 ? argv[6] : "reflecting";
+    config.boundary = boundary == "free"        ? WalkBoundary::Free
+                      : boundary == "absorbing" ? WalkBoundary::Absorbing
+                                                : WalkBoundary::Reflecting;
+    config.space = argc > 7 && std::string(argv[7]) == "continuous" ? WalkSpace::Continuous : WalkSpace::Lattice;
+    printLatticeWalks(config, argc > 8 ? argv[8] : "auto");
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "check") {
+    int steps = argc > 3 ? std::stoi(argv[3]) : 100;
+    printCrossCheck(argc > 2 ? std::stoll(argv[2]) : 1000000, steps, argc > 4 ? std::stod(argv[4]) : 2.0 / 3,
+                    argc > 5 ? std::stoi(argv[5]) : std::max(1, steps / 4));
+    return checkBinaryRoundTrip() ? 0 : 1;
+  }
+
+  WalkConfig config;
+  config.walkers = argc > 1 ? std::stoll(argv[1]) : 100000;
+  config.steps = argc > 2 ? std::stoi(argv[2]) : 100;
+  config.posP = argc > 3 ? std::stod(argv[3]) : 2.0 / 3;
+  config.threads = argc > 4 ? std::stoi(argv[4]) : 0;
+  std::string stepping = argc > 5 ? argv[5] : "bits";
+  config.stepping = stepping == "scalar"     ? WalkStepping::Scalar
+                    : stepping == "binomial" ? WalkStepping::Binomial
+                                             : WalkStepping::BitParallel;
+
+  auto begin = std::chrono::steady_clock::now();
+  WalkResult result = runWalks(config);
+  auto finish = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(finish - begin).count();
+
+  double expectedMean = config.steps * (2 * config.posP - 1);
+  double expectedVariance = 4.0 * config.steps * config.posP * (1 - config.posP);
+  std::cout << "walkers = " << config.walkers << ", steps = " << config.steps << ", p = " << config.posP
+            << ", threads = " << walkThreadCount(config.threads)
+            << ", stepping = " << stepping << "\n";
+  std::cout << "time = " << seconds * 1000 << " ms, " << config.walkers * config.steps / seconds << " steps/s\n";
+  std::cout << "mean = " << result.mean() << " (expected " << expectedMean << "), variance = " << result.variance()
+            << " (expected " << expectedVariance << ")\n";
+
+  // Moments and the non-empty bins of the endpoint histogram
+  writeTable(walkResultTable(config, result),
+             "randwalk_k" + std::to_string(config.steps) + "_" + std::to_string(config.walkers),
+             argc > 6 ? argv[6] : "auto");
 }
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "array_utility.h"
+#include "basic_sort.h"
+#include "block_partition.h"
+#include "intro_sort.h"
+#include "parallel_merge_sort.h"
+#include "parallel_quick_sort.h"
+#include "parallel_sample_sort.h"
+#include "perf_counters.h"
+#include "radix_sort.h"
+#include "simd_sort.h"
+#include "tim_sort.h"
+#include "work_stealing_pool.h"
+
+// Sort benchmark: every algorithm on every input shape and size, timed over
+// repeated trials on a fresh copy of the same array.
+//
+// Usage: sort_bench [--min N] [--max N] [--trials N]
+//                   [--sorts quick,intro,...] [--inputs random,sorted,...]
+//                   [--csv FILE] [--json FILE]
+// Sizes sweep powers of ten from --min (1000) to --max (10000000); pass
+// --max 1000000000 for the full sweep up to 1B elements.
+// The threaded sorts share one pool of hardware_concurrency workers, started
+// before any trial, so thread startup is not timed.
+
+// Fewer trials leave no room between the 99th percentile and the maximum;
+// p99 is reported from this many trials on
+constexpr int BENCH_P99_MIN_TRIALS = 100;
+
+struct SortAlgorithm
+{
+    std::string name;
+    void (*sort)(int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &pool);
+    long long maxSize; // larger problems are skipped
+};
+
+struct InputShape
+{
+    std::string name;
+    void (*make)(int *array, const int &size);
+};
+
+struct BenchResult
+{
+    std::string sort;
+    std::string input;
+    int size;
+    int trials;
+    double medianTime;
+    double p99Time; // NaN below BENCH_P99_MIN_TRIALS trials
+    double minTime;
+    double maxTime;
+    SortCount step;
+    SortCount swapCount;
+    bool sorted;
+    PerfSample perf; // hardware counters of the median trial
+};
+
+const std::vector<SortAlgorithm> &sortAlgorithms()
+{
+    static const std::vector<SortAlgorithm> algorithms = {
+        {"bubble", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { bubbleSort(array, size, step, swapCount); }, 100000},
+        {"insert", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { insertSort(array, size, step, swapCount); }, 100000},
+        {"quick", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { quickSort(array, 0, size - 1, step, swapCount); }, 1LL << 40},
+        {"block", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { blockQuickSort(array, 0, size - 1, step, swapCount); }, 1LL << 40},
+        {"intro", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { introSort(array, 0, size - 1, step, swapCount); }, 1LL << 40},
+        {"heap", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { heapSort(array, size, step, swapCount); }, 1LL << 40},
+        {"radix", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { radixSort(array, size, step, swapCount); }, 1LL << 40},
+        {"simd", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { simdQuickSort(array, 0, size - 1, step, swapCount); }, 1LL << 40},
+        {"tim", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &) { timSort(array, size, step, swapCount); }, 1LL << 40},
+        {"parallel", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &pool) {
+             parallelQuickSort(pool, array, 0, size - 1, step, swapCount);
+         },
+         1LL << 40},
+        {"sample", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &pool) {
+             parallelSampleSort(pool, array, size, step, swapCount);
+         },
+         1LL << 40},
+        {"pmerge", [](int *array, int size, SortCount &step, SortCount &swapCount, WorkStealingPool &pool) {
+             parallelMergeSort(pool, array, size, step, swapCount);
+         },
+         1LL << 40},
+    };
+    return algorithms;
+}
+
+const std::vector<InputShape> &inputShapes()
+{
+    static const std::vector<InputShape> shapes = {
+        {"random", makeArrayRandomFull},
+        {"random100k", makeArrayRandom},
+        {"sorted", makeArraySorted},
+        {"inverse", makeArrayInverse},
+        {"few_unique", makeArrayFewUnique},
+        {"organ_pipe", makeArrayOrganPipe},
+        {"sawtooth", makeArraySawtooth},
+    };
+    return shapes;
+}
+
+std::vector<std::string> splitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        items.push_back(item);
+    }
+    return items;
+}
+
+bool selected(const std::vector<std::string> &filter, const std::string &name)
+{
+    return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+}
+
+// Nearest-rank percentile of sorted times
+double percentile(const std::vector<double> &times, const double &p)
+{
+    std::size_t rank = static_cast<std::size_t>(p * times.size() + 0.999999);
+    return times[std::min(std::max<std::size_t>(rank, 1), times.size()) - 1];
+}
+
+// Counters are opened before the pool starts its workers, so that the
+// workers' events are counted too
+BenchResult runBenchmark(const SortAlgorithm &algorithm, const InputShape &shape, const std::vector<int> &problem, const int &trials,
+                         WorkStealingPool &pool, PerfCounters &counters)
+{
+    int size = static_cast<int>(problem.size());
+    std::vector<int> array(size);
+    std::vector<double> times;
+    std::vector<PerfSample> perfs;
+    BenchResult result = {algorithm.name, shape.name, size, trials, 0, 0, 0, 0, 0, 0, true, PerfSample()};
+
+    for (int trial = 0; trial < trials; trial++)
+    {
+        std::copy(problem.begin(), problem.end(), array.begin());
+        SortCount step = 0;
+        SortCount swapCount = 0;
+
+        auto begin = std::chrono::steady_clock::now();
+        PerfSample perf = measureSort(counters, [&] { algorithm.sort(array.data(), size, step, swapCount, pool); });
+        auto finish = std::chrono::steady_clock::now();
+
+        times.push_back(std::chrono::duration<double, std::milli>(finish - begin).count());
+        perfs.push_back(perf);
+        result.step = step;
+        result.swapCount = swapCount;
+        result.sorted = result.sorted && isSorted(array.data(), size);
+    }
+
+    std::vector<int> order(trials);
+    for (int i = 0; i < trials; i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&times](const int &a, const int &b) { return times[a] < times[b]; });
+    result.perf = perfs[order[trials / 2]];
+
+    std::sort(times.begin(), times.end());
+    result.medianTime = percentile(times, 0.5);
+    result.p99Time = trials >= BENCH_P99_MIN_TRIALS ? percentile(times, 0.99) : NAN;
+    result.minTime = times.front();
+    result.maxTime = times.back();
+    return result;
+}
+
+void writeCsv(std::ostream &out, const std::vector<BenchResult> &results)
+{
+    out << "sort,input,size,trials,median_ms,p99_ms,min_ms,max_ms,step,swap,sorted,cycles,instructions,cache_misses,branch_misses\n";
+    for (const BenchResult &r : results)
+    {
+        out << r.sort << "," << r.input << "," << r.size << "," << r.trials << "," << r.medianTime << ",";
+        if (!std::isnan(r.p99Time))
+        {
+            out << r.p99Time;
+        }
+        out << "," << r.minTime << "," << r.maxTime << ","
+            << r.step << "," << r.swapCount << "," << (r.sorted ? "true" : "false") << ",";
+        if (r.perf.valid)
+        {
+            out << r.perf.cycles << "," << r.perf.instructions << "," << r.perf.cacheMisses << "," << r.perf.branchMisses << "\n";
+        }
+        else
+        {
+            out << ",,,\n";
+        }
+    }
+}
+
+void writeJson(std::ostream &out, const std::vector<BenchResult> &results)
+{
+    out << "[\n";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        out << "  {\"sort\": \"" << r.sort << "\", \"input\": \"" << r.input << "\", \"size\": " << r.size
+            << ", \"trials\": " << r.trials << ", \"median_ms\": " << r.medianTime << ", \"p99_ms\": ";
+        if (std::isnan(r.p99Time))
+        {
+            out << "null";
+        }
+        else
+        {
+            out << r.p99Time;
+        }
+        out << ", \"min_ms\": " << r.minTime << ", \"max_ms\": " << r.maxTime << ", \"step\": " << r.step << ", \"swap\": " << r.swapCount
+            << ", \"sorted\": " << (r.sorted ? "true" : "false");
+        if (r.perf.valid)
+        {
+            out << ", \"cycles\": " << r.perf.cycles << ", \"instructions\": " << r.perf.instructions
+                << ", \"cache_misses\": " << r.perf.cacheMisses << ", \"branch_misses\": " << r.perf.branchMisses;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+int main(int argc, char **argv)
+{
+    long long minSize = 1000;
+    long long maxSize = 10000000;
+    int trials = 5;
+    std::vector<std::string> sortFilter;
+    std::vector<std::string> inputFilter;
+    std::string csvPath;
+    std::string jsonPath;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--min")
+        {
+            minSize = std::stoll(value);
+        }
+        else if (option == "--max")
+        {
+            maxSize = std::stoll(value);
+        }
+        else if (option == "--trials")
+        {
+            trials = std::max(std::stoi(value), 1);
+        }
+        else if (option == "--sorts")
+        {
+            sortFilter = splitList(value);
+        }
+        else if (option == "--inputs")
+        {
+            inputFilter = splitList(value);
+        }
+        else if (option == "--csv")
+        {
+            csvPath = value;
+        }
+        else if (option == "--json")
+        {
+            jsonPath = value;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    PerfCounters counters;
+    WorkStealingPool pool(static_cast<int>(std::thread::hardware_concurrency()));
+
+    std::vector<BenchResult> results;
+    for (long long size = minSize; size <= maxSize; size *= 10)
+    {
+        for (const InputShape &shape : inputShapes())
+        {
+            if (!selected(inputFilter, shape.name))
+            {
+                continue;
+            }
+            std::vector<int> problem(size);
+            shape.make(problem.data(), static_cast<int>(size));
+
+            for (const SortAlgorithm &algorithm : sortAlgorithms())
+            {
+                if (!selected(sortFilter, algorithm.name) || size > algorithm.maxSize)
+                {
+                    continue;
+                }
+                BenchResult r = runBenchmark(algorithm, shape, problem, trials, pool, counters);
+                std::cout << r.sort << " " << r.input << " " << r.size << "-> median = " << r.medianTime << " ms";
+                if (!std::isnan(r.p99Time))
+                {
+                    std::cout << ", p99 = " << r.p99Time << " ms";
+                }
+                std::cout << ", max = " << r.maxTime << " ms, step = " << r.step << ", swap = " << r.swapCount
+                          << (r.sorted ? "" : " (NOT SORTED)");
+                if (r.perf.valid)
+                {
+                    std::cout << ", cycles = " << r.perf.cycles << ", instructions = " << r.perf.instructions
+                              << ", cache misses = " << r.perf.cacheMisses << ", branch misses = " << r.perf.branchMisses;
+                }
+                std::cout << std::endl;
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (!csvPath.empty())
+    {
+        std::ofstream csv(csvPath);
+        writeCsv(csv, results);
+    }
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        writeJson(json, results);
+    }
+}
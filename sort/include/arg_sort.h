@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include "basic_sort.h"
+#include "intro_sort.h"
+
+// Indirect sort: returns the order of indices that sorts array by its projected
+// keys and leaves the elements where they are, so only ints are ever moved.
+template <typename T, typename Proj = Identity>
+std::vector<int> argSort(const T *array, const int &size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    std::vector<int> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    auto key = [array, &proj](const int &i) -> decltype(auto) { return std::invoke(proj, array[i]); };
+    introSort(order.data(), 0, size - 1, step, swapCount, key);
+    return order;
+}
+
+// Rearranges array in place so that array[i] becomes the old array[order[i]].
+// Follows the cycles of the permutation, moving every element once.
+template <typename T>
+void applyOrder(T *array, const std::vector<int> &order)
+{
+    std::vector<bool> done(order.size(), false);
+    for (int i = 0; i < static_cast<int>(order.size()); i++)
+    {
+        if (done[i])
+        {
+            continue;
+        }
+        T tmp = std::move(array[i]);
+        int j = i;
+        while (order[j] != i)
+        {
+            array[j] = std::move(array[order[j]]);
+            done[j] = true;
+            j = order[j];
+        }
+        array[j] = std::move(tmp);
+        done[j] = true;
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include "int_io.h"
+
+inline void printArray(int *array, const int &size)
+{
+    std::cout.flush();
+    writeText(stdout, array, size, ' ');
+}
+
+inline void makeArrayRandom(int *array, const int &size)
+{
+    std::random_device seed_gen;
+    std::mt19937 engine(seed_gen());
+    std::uniform_int_distribution<int> dist(1, 100000);
+
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = dist(engine);
+    }
+}
+
+inline void makeArrayInverse(int *array, const int &size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = size - i;
+    }
+}
+
+// Reads up to size integers from stdin; the rest of the array is left as is
+inline void makeArrayInput(int *array, const int &size)
+{
+    readText("-", array, size);
+}
+
+inline bool isSorted(const int *array, const int &size)
+{
+    for (int i = 1; i < size; i++)
+    {
+        if (array[i] < array[i - 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Further input shapes for benchmarks. Unlike makeArrayRandom they use a fixed
+// seed, so every trial and every run sees the same array.
+
+inline void makeArraySorted(int *array, const int &size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = i + 1;
+    }
+}
+
+// Uniform over the whole int range
+inline void makeArrayRandomFull(int *array, const int &size)
+{
+    std::mt19937 engine(size);
+    std::uniform_int_distribution<int> dist;
+
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = dist(engine);
+    }
+}
+
+// Only 16 distinct keys
+inline void makeArrayFewUnique(int *array, const int &size)
+{
+    std::mt19937 engine(size);
+    std::uniform_int_distribution<int> dist(1, 16);
+
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = dist(engine);
+    }
+}
+
+// Ascending first half, descending second half
+inline void makeArrayOrganPipe(int *array, const int &size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = i < size / 2 ? i : size - i;
+    }
+}
+
+// Ascending runs of 1000 keys each
+inline void makeArraySawtooth(int *array, const int &size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        array[i] = i % 1000;
+    }
+}
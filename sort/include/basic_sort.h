@@ -0,0 +1,201 @@
+#pragma once
+#include <functional>
+#include <utility>
+
+// Logical step/swap counters; 64-bit so large inputs do not overflow them
+using SortCount = long long;
+
+// Exchanges two elements by moving them; swap overloads found by ADL
+// (std::string, containers, ...) are used when they exist
+template <typename T>
+void swapElements(T &x, T &y)
+{
+    using std::swap;
+    swap(x, y);
+}
+
+// Default projection: sorts compare the elements themselves
+struct Identity
+{
+    template <typename T>
+    constexpr T &&operator()(T &&x) const
+    {
+        return std::forward<T>(x);
+    }
+};
+
+// Compares two elements by their projected keys. proj may be any callable or a
+// pointer to member, e.g. &Record::key.
+template <typename Proj, typename T>
+bool lessBy(Proj &proj, const T &x, const T &y)
+{
+    return std::invoke(proj, x) < std::invoke(proj, y);
+}
+
+template <typename T>
+T median(const T &x, const T &y, const T &z)
+{
+    if (x < y)
+    {
+        if (y < z)
+        {
+            return y;
+        }
+        else if (z < x)
+        {
+            return x;
+        }
+        else
+        {
+            return z;
+        }
+    }
+    else
+    {
+        if (z < y)
+        {
+            return y;
+        }
+        else if (x < z)
+        {
+            return x;
+        }
+        else
+        {
+            return z;
+        }
+    }
+}
+
+template <typename T>
+T getPivot(const T *array, const int &start, const int &end)
+{
+    return median(array[start], array[start + (end - start) / 2], array[end]);
+}
+
+// Position of the median of array[a], array[b], array[c]; nothing is copied
+template <typename T, typename Proj = Identity>
+int medianIndex(const T *array, const int &a, const int &b, const int &c, Proj proj = Proj())
+{
+    if (lessBy(proj, array[a], array[b]))
+    {
+        if (lessBy(proj, array[b], array[c]))
+        {
+            return b;
+        }
+        return lessBy(proj, array[c], array[a]) ? a : c;
+    }
+    if (lessBy(proj, array[c], array[b]))
+    {
+        return b;
+    }
+    return lessBy(proj, array[a], array[c]) ? a : c;
+}
+
+template <typename T, typename Proj = Identity>
+void bubbleSort(T *array, int size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    for (int i = 0; i < size - 1; i++)
+    {
+        for (int j = 1; j < size - i; j++)
+        {
+            step++;
+            if (lessBy(proj, array[j], array[j - 1]))
+            {
+                swapElements(array[j], array[j - 1]);
+                ++swapCount;
+            }
+        }
+    }
+}
+
+template <typename T, typename Proj = Identity>
+void insertSort(T *array, const int &size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    for (int i = 1; i < size; i++)
+    {
+        for (int j = i; j > 0; j--)
+        {
+            ++step;
+            if (lessBy(proj, array[j], array[j - 1]))
+            {
+                swapElements(array[j - 1], array[j]);
+                ++swapCount;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+}
+
+// Hoare partition of array[start..end] around the median of three.
+// The median is moved to array[start] and compared in place, so the pivot is
+// never copied; the other two candidates stop both scans without bound checks.
+// Afterwards array[start..i-1] <= pivot and array[j+1..end] >= pivot.
+template <typename T, typename Proj = Identity>
+void hoarePartition(T *array, const int &start, const int &end, int &i, int &j, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    if (end - start < 3)
+    {
+        // Too short for three distinct candidates besides array[start]
+        insertSort(array + start, end - start + 1, step, swapCount, proj);
+        i = j = start + (end - start) / 2;
+        return;
+    }
+
+    int m = medianIndex(array, start + 1, start + 1 + (end - start - 1) / 2, end, proj);
+    swapElements(array[start], array[m]);
+    ++swapCount;
+    const T &pivot = array[start];
+
+    i = start + 1;
+    j = end;
+    while (true)
+    {
+
+        while (lessBy(proj, array[i], pivot))
+        {
+            ++step;
+            ++i;
+        }
+        ++step;
+
+        while (lessBy(proj, pivot, array[j]))
+        {
+            ++step;
+            --j;
+        }
+        ++step;
+
+        if (i >= j)
+        {
+            break;
+        }
+
+        swapElements(array[i], array[j]);
+        ++swapCount;
+
+        ++i;
+        --j;
+    }
+
+    // Put the pivot between the two sides; it is in its final place
+    i = j = i - 1;
+    swapElements(array[start], array[i]);
+    ++swapCount;
+}
+
+template <typename T, typename Proj = Identity>
+void quickSort(T *array, int start, int end, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    if (start < end)
+    {
+        int i, j;
+        hoarePartition(array, start, end, i, j, step, swapCount, proj);
+
+        quickSort(array, start, i - 1, step, swapCount, proj);
+        quickSort(array, j + 1, end, step, swapCount, proj);
+    }
+}
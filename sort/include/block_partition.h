@@ -0,0 +1,134 @@
+#pragma once
+#include "basic_sort.h"
+#include "intro_sort.h"
+
+// Number of elements classified per block; offsets into a block fit in one byte
+constexpr int PARTITION_BLOCK_SIZE = 128;
+
+// BlockQuicksort partition (Edelkamp and Weiss).
+// Comparison results for a block on each side are first written into offset
+// buffers without branching on the data, then the misplaced elements are swapped
+// pairwise. Returns the final pivot position p with array[start..p-1] <= pivot
+// and array[p+1..end] >= pivot.
+template <typename T>
+int blockPartition(T *array, const int &start, const int &end, SortCount &step, SortCount &swapCount)
+{
+    int m = medianIndex(array, start, start + (end - start) / 2, end);
+    swapElements(array[m], array[end]);
+    ++swapCount;
+    const T &pivot = array[end];
+
+    unsigned char offsetsL[PARTITION_BLOCK_SIZE];
+    unsigned char offsetsR[PARTITION_BLOCK_SIZE];
+    int numL = 0, numR = 0;
+    int startL = 0, startR = 0;
+
+    int l = start;
+    int r = end - 1;
+
+    while (r - l + 1 >= 2 * PARTITION_BLOCK_SIZE)
+    {
+        if (numL == 0)
+        {
+            startL = 0;
+            for (int i = 0; i < PARTITION_BLOCK_SIZE; i++)
+            {
+                offsetsL[numL] = static_cast<unsigned char>(i);
+                numL += !(array[l + i] < pivot);
+            }
+            step += PARTITION_BLOCK_SIZE;
+        }
+        if (numR == 0)
+        {
+            startR = 0;
+            for (int i = 0; i < PARTITION_BLOCK_SIZE; i++)
+            {
+                offsetsR[numR] = static_cast<unsigned char>(i);
+                numR += !(pivot < array[r - i]);
+            }
+            step += PARTITION_BLOCK_SIZE;
+        }
+
+        int num = numL < numR ? numL : numR;
+        for (int k = 0; k < num; k++)
+        {
+            swapElements(array[l + offsetsL[startL + k]], array[r - offsetsR[startR + k]]);
+        }
+        swapCount += num;
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+
+        if (numL == 0)
+        {
+            l += PARTITION_BLOCK_SIZE;
+        }
+        if (numR == 0)
+        {
+            r -= PARTITION_BLOCK_SIZE;
+        }
+    }
+
+    // Fewer than two blocks remain, possibly including one half-processed block.
+    // Finish them with a branchless Lomuto pass: array[l..k-1] < pivot <= array[k..r]
+    int k = l;
+    for (int i = l; i <= r; i++)
+    {
+        bool less = array[i] < pivot;
+        swapElements(array[i], array[k]);
+        k += less;
+    }
+    step += r - l + 1;
+    swapCount += r - l + 1;
+
+    swapElements(array[k], array[end]);
+    ++swapCount;
+    return k;
+}
+
+// blockQuickSort below the top level: recurses into the smaller side and
+// loops on the larger one, and hands a range to heapSort once depthLimit
+// partitions have not made it short
+template <typename T>
+void blockQuickSortLoop(T *array, int start, int end, int depthLimit, SortCount &step, SortCount &swapCount)
+{
+    while (end - start + 1 >= 2 * PARTITION_BLOCK_SIZE)
+    {
+        if (depthLimit == 0)
+        {
+            heapSort(array + start, end - start + 1, step, swapCount);
+            return;
+        }
+        --depthLimit;
+
+        int p = blockPartition(array, start, end, step, swapCount);
+        if (p - start < end - p)
+        {
+            blockQuickSortLoop(array, start, p - 1, depthLimit, step, swapCount);
+            start = p + 1;
+        }
+        else
+        {
+            blockQuickSortLoop(array, p + 1, end, depthLimit, step, swapCount);
+            end = p - 1;
+        }
+    }
+
+    introSort(array, start, end, step, swapCount);
+}
+
+// quickSort with blockPartition in place of the Hoare partition loop, with
+// introSort's budget of 2*log2(n) partitions before heapSort takes over.
+// Ranges too short for two blocks go to introSort, because the Lomuto pass
+// would put every key equal to the pivot on one side.
+template <typename T>
+void blockQuickSort(T *array, int start, int end, SortCount &step, SortCount &swapCount)
+{
+    int depthLimit = 0;
+    for (int n = end - start + 1; n > 1; n >>= 1)
+    {
+        depthLimit += 2;
+    }
+    blockQuickSortLoop(array, start, end, depthLimit, step, swapCount);
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "intro_sort.h"
+#include "kway_merge.h"
+
+// Smallest read buffer per run during a merge; bounds the merge fan-in
+constexpr std::size_t EXTERNAL_SORT_MIN_BLOCK_BYTES = 1 << 16;
+
+// Anonymous temporary run file; the system deletes it once it is closed
+inline RunFile openRunFile()
+{
+    RunFile file(std::tmpfile(), &std::fclose);
+    if (file == nullptr)
+    {
+        throw std::runtime_error("external sort: failed to create temporary file");
+    }
+    return file;
+}
+
+// Writes a sorted chunk into a new run file in RunReader's format, straight
+// from memory on little-endian hosts
+template <typename T>
+RunFile spillRun(const std::vector<T> &chunk)
+{
+    RunFile file = openRunFile();
+    if (hostIsLittleEndian())
+    {
+        if (std::fwrite(chunk.data(), sizeof(T), chunk.size(), file.get()) != chunk.size())
+        {
+            throw std::runtime_error("external sort: failed to write run file");
+        }
+    }
+    else
+    {
+        RunWriter<T> writer(file.get(), EXTERNAL_SORT_MIN_BLOCK_BYTES / sizeof(T));
+        for (const T &x : chunk)
+        {
+            writer(x);
+        }
+        writer.flush();
+    }
+    return file;
+}
+
+// k-way merge of sorted run files into sink, reading each through a buffer of
+// blockSize values. Each file is flushed before it is rewound, since rewind
+// would drop the error of a failed write.
+template <typename T, typename Sink>
+void mergeRuns(const std::vector<RunFile> &runs, std::size_t blockSize, Sink &sink, SortCount &step, SortCount &swapCount)
+{
+    std::vector<RunReader<T>> readers;
+    readers.reserve(runs.size());
+    for (const RunFile &file : runs)
+    {
+        if (std::fflush(file.get()) != 0 || std::ferror(file.get()) || std::fseek(file.get(), 0, SEEK_SET) != 0)
+        {
+            throw std::runtime_error("external sort: failed to write run file");
+        }
+        readers.emplace_back(file.get(), blockSize);
+    }
+    kWayMerge<T>(readers, sink, step, swapCount);
+}
+
+// Sorts whitespace separated values from in to out (one per line) using about
+// memoryBudget bytes: chunks that fill the budget are sorted with introSort and
+// spilled to temporary files, then merged with a loser tree. When there are more
+// runs than the budget can buffer, groups of runs are merged into longer runs first.
+template <typename T>
+void externalSort(std::istream &in, std::ostream &out, std::size_t memoryBudget, SortCount &step, SortCount &swapCount)
+{
+    std::size_t chunkSize = std::max<std::size_t>(memoryBudget / sizeof(T), 1);
+    // Every run file is closed, and so deleted, when it leaves this vector,
+    // also when a write or the input throws
+    std::vector<RunFile> runs;
+
+    {
+        std::vector<T> chunk;
+        chunk.reserve(chunkSize);
+        T value;
+        while (in >> value)
+        {
+            chunk.push_back(value);
+            if (chunk.size() == chunkSize)
+            {
+                introSort(chunk.data(), 0, static_cast<int>(chunk.size()) - 1, step, swapCount);
+                runs.push_back(spillRun(chunk));
+                chunk.clear();
+            }
+        }
+
+        // A short last chunk never touches the disk
+        introSort(chunk.data(), 0, static_cast<int>(chunk.size()) - 1, step, swapCount);
+        if (runs.empty())
+        {
+            for (const T &x : chunk)
+            {
+                out << x << "\n";
+            }
+            if (!out.flush())
+            {
+                throw std::runtime_error("external sort: failed to write output");
+            }
+            return;
+        }
+        if (!chunk.empty())
+        {
+            runs.push_back(spillRun(chunk));
+        }
+    }
+
+    // One buffer per input run plus one for the output
+    std::size_t fanIn = std::max<std::size_t>(memoryBudget / EXTERNAL_SORT_MIN_BLOCK_BYTES, 3) - 1;
+    while (runs.size() > fanIn)
+    {
+        std::vector<RunFile> group(std::make_move_iterator(runs.begin()), std::make_move_iterator(runs.begin() + fanIn));
+        runs.erase(runs.begin(), runs.begin() + fanIn);
+        std::size_t blockSize = std::max<std::size_t>(memoryBudget / (fanIn + 1) / sizeof(T), 1);
+        RunFile merged = openRunFile();
+        RunWriter<T> writer(merged.get(), blockSize);
+        mergeRuns<T>(group, blockSize, writer, step, swapCount);
+        writer.flush();
+        runs.push_back(std::move(merged));
+    }
+
+    std::size_t blockSize = std::max<std::size_t>(memoryBudget / (runs.size() + 1) / sizeof(T), 1);
+    auto print = [&out](const T &x) { out << x << "\n"; };
+    mergeRuns<T>(runs, blockSize, print, step, swapCount);
+    for (RunFile &file : runs)
+    {
+        closeRunFile(file);
+    }
+    if (!out.flush())
+    {
+        throw std::runtime_error("external sort: failed to write output");
+    }
+}
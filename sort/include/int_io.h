@@ -0,0 +1,349 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Fast integer I/O for sort input and output.
+// Text input is memory-mapped where possible and parsed by a hand-rolled
+// scanner; text output goes through std::to_chars into a large buffer that is
+// written in blocks. The binary format is the raw array, little-endian.
+
+#if defined(__unix__) || defined(__APPLE__)
+#define INT_IO_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Output buffer of IntWriter and block size of the binary writer
+constexpr std::size_t INT_IO_BUFFER_BYTES = 1 << 20;
+
+// Whole contents of a file, "-" meaning stdin. Regular files are mapped;
+// pipes, terminals and systems without mmap are read into a buffer.
+class MappedInput
+{
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::vector<char> buffer_;
+#ifdef INT_IO_HAS_MMAP
+    void *mapping_ = nullptr;
+#endif
+
+    void readAll(std::FILE *file)
+    {
+        std::size_t capacity = INT_IO_BUFFER_BYTES;
+        buffer_.resize(capacity);
+        std::size_t used = 0;
+        while (std::size_t got = std::fread(buffer_.data() + used, 1, capacity - used, file))
+        {
+            used += got;
+            if (used == capacity)
+            {
+                capacity *= 2;
+                buffer_.resize(capacity);
+            }
+        }
+        if (std::ferror(file))
+        {
+            throw std::runtime_error("int io: failed to read input");
+        }
+        buffer_.resize(used);
+        data_ = buffer_.data();
+        size_ = used;
+    }
+
+public:
+    explicit MappedInput(const std::string &path)
+    {
+        bool fromStdin = path == "-";
+#ifdef INT_IO_HAS_MMAP
+        int fd = fromStdin ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("int io: cannot open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            void *mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                ::madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                mapping_ = mapping;
+                data_ = static_cast<const char *>(mapping);
+                size_ = info.st_size;
+            }
+        }
+        if (!fromStdin)
+        {
+            ::close(fd);
+        }
+        if (mapping_ != nullptr)
+        {
+            return;
+        }
+#endif
+        std::FILE *file = fromStdin ? stdin : std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            throw std::runtime_error("int io: cannot open " + path);
+        }
+        try
+        {
+            readAll(file);
+        }
+        catch (...)
+        {
+            if (!fromStdin)
+            {
+                std::fclose(file);
+            }
+            throw;
+        }
+        if (!fromStdin)
+        {
+            std::fclose(file);
+        }
+    }
+
+    ~MappedInput()
+    {
+#ifdef INT_IO_HAS_MMAP
+        if (mapping_ != nullptr)
+        {
+            ::munmap(mapping_, size_);
+        }
+#endif
+    }
+
+    MappedInput(const MappedInput &) = delete;
+    MappedInput &operator=(const MappedInput &) = delete;
+
+    const char *data() const
+    {
+        return data_;
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+};
+
+// Calls sink with every integer in [begin, end). Any byte other than a digit
+// or a '-' directly before one separates numbers. A value outside the range
+// of T throws runtime_error.
+template <typename T, typename Sink>
+void scanIntegers(const char *begin, const char *end, Sink sink)
+{
+    static_assert(std::is_integral<T>::value, "scanIntegers needs an integer type");
+    using U = std::make_unsigned_t<T>;
+
+    const char *p = begin;
+    while (p != end)
+    {
+        bool negative = false;
+        if (*p == '-')
+        {
+            negative = true;
+            ++p;
+        }
+        if (p == end || static_cast<unsigned char>(*p - '0') > 9)
+        {
+            if (!negative)
+            {
+                ++p;
+            }
+            continue;
+        }
+
+        // Largest magnitude T can hold with this sign
+        U limit = negative ? U(0) - static_cast<U>(std::numeric_limits<T>::min()) : static_cast<U>(std::numeric_limits<T>::max());
+        U value = 0;
+        do
+        {
+            U digit = static_cast<U>(*p - '0');
+            if (value > (limit - digit) / 10)
+            {
+                throw std::runtime_error("int io: integer out of range");
+            }
+            value = value * 10 + digit;
+            ++p;
+        } while (p != end && static_cast<unsigned char>(*p - '0') <= 9);
+        sink(static_cast<T>(negative ? U(0) - value : value));
+    }
+}
+
+// All integers of a text file ("-" for stdin)
+template <typename T>
+std::vector<T> readText(const std::string &path)
+{
+    MappedInput input(path);
+    std::vector<T> values;
+    scanIntegers<T>(input.data(), input.data() + input.size(), [&](const T &x) { values.push_back(x); });
+    return values;
+}
+
+// Reads at most size integers into array; returns how many were read
+template <typename T>
+int readText(const std::string &path, T *array, const int &size)
+{
+    MappedInput input(path);
+    int count = 0;
+    scanIntegers<T>(input.data(), input.data() + input.size(), [&](const T &x) {
+        if (count < size)
+        {
+            array[count++] = x;
+        }
+    });
+    return count;
+}
+
+// Reverses the bytes of x; used to keep the binary format little-endian
+template <typename T>
+T byteSwap(T x)
+{
+    unsigned char *bytes = reinterpret_cast<unsigned char *>(&x);
+    for (std::size_t i = 0; i < sizeof(T) / 2; i++)
+    {
+        unsigned char byte = bytes[i];
+        bytes[i] = bytes[sizeof(T) - 1 - i];
+        bytes[sizeof(T) - 1 - i] = byte;
+    }
+    return x;
+}
+
+constexpr bool hostIsLittleEndian()
+{
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return false;
+#else
+    return true;
+#endif
+}
+
+// Raw little-endian array from a binary file ("-" for stdin)
+template <typename T>
+std::vector<T> readBinary(const std::string &path)
+{
+    MappedInput input(path);
+    if (input.size() % sizeof(T) != 0)
+    {
+        throw std::runtime_error("int io: binary input size is not a multiple of the element size");
+    }
+    std::vector<T> values(input.size() / sizeof(T));
+    if (!values.empty())
+    {
+        std::memcpy(values.data(), input.data(), input.size());
+    }
+    if (!hostIsLittleEndian())
+    {
+        for (T &x : values)
+        {
+            x = byteSwap(x);
+        }
+    }
+    return values;
+}
+
+// Buffered text writer of integers; flush() must be called once at the end
+class IntWriter
+{
+private:
+    std::FILE *file_;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+
+    // Longest integer text (a 64-bit minimum) plus a separator
+    static constexpr std::size_t MaxFieldBytes = 21;
+
+    void writeBuffer()
+    {
+        if (used_ != 0 && std::fwrite(buffer_.data(), 1, used_, file_) != used_)
+        {
+            throw std::runtime_error("int io: failed to write output");
+        }
+        used_ = 0;
+    }
+
+public:
+    explicit IntWriter(std::FILE *file, std::size_t bufferBytes = INT_IO_BUFFER_BYTES)
+        : file_(file), buffer_(bufferBytes < MaxFieldBytes ? MaxFieldBytes : bufferBytes) {}
+
+    template <typename T>
+    void write(const T &value, const char &separator = '\n')
+    {
+        if (buffer_.size() - used_ < MaxFieldBytes)
+        {
+            writeBuffer();
+        }
+        char *out = buffer_.data() + used_;
+        out = std::to_chars(out, buffer_.data() + buffer_.size(), value).ptr;
+        *out++ = separator;
+        used_ = out - buffer_.data();
+    }
+
+    void flush()
+    {
+        writeBuffer();
+        if (std::fflush(file_) != 0)
+        {
+            throw std::runtime_error("int io: failed to write output");
+        }
+    }
+};
+
+template <typename T>
+void writeText(std::FILE *file, const T *array, const int &size, const char &separator = '\n')
+{
+    IntWriter writer(file);
+    for (int i = 0; i < size; i++)
+    {
+        writer.write(array[i], separator);
+    }
+    writer.flush();
+}
+
+// Writes array as raw little-endian values, byte-swapping in blocks on
+// big-endian hosts
+template <typename T>
+void writeBinary(std::FILE *file, const T *array, const int &size)
+{
+    std::size_t count = size;
+    if (hostIsLittleEndian())
+    {
+        if (std::fwrite(array, sizeof(T), count, file) != count)
+        {
+            throw std::runtime_error("int io: failed to write output");
+        }
+    }
+    else
+    {
+        std::vector<T> block;
+        block.reserve(INT_IO_BUFFER_BYTES / sizeof(T));
+        for (std::size_t i = 0; i < count;)
+        {
+            block.clear();
+            for (; i < count && block.size() < block.capacity(); i++)
+            {
+                block.push_back(byteSwap(array[i]));
+            }
+            if (std::fwrite(block.data(), sizeof(T), block.size(), file) != block.size())
+            {
+                throw std::runtime_error("int io: failed to write output");
+            }
+        }
+    }
+    if (std::fflush(file) != 0)
+    {
+        throw std::runtime_error("int io: failed to write output");
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "basic_sort.h"
+#include "sorting_network.h"
+
+// Partitions at most this long are finished by a sorting network
+constexpr int SMALL_SORT_THRESHOLD = 16;
+static_assert(SMALL_SORT_THRESHOLD <= SORTING_NETWORK_MAX, "small partitions need a sorting network");
+
+template <typename T, typename Proj = Identity>
+void siftDown(T *array, int root, const int &size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    while (true)
+    {
+        int child = 2 * root + 1;
+        if (child >= size)
+        {
+            return;
+        }
+        if (child + 1 < size)
+        {
+            ++step;
+            if (lessBy(proj, array[child], array[child + 1]))
+            {
+                ++child;
+            }
+        }
+        ++step;
+        if (!lessBy(proj, array[root], array[child]))
+        {
+            return;
+        }
+        swapElements(array[root], array[child]);
+        ++swapCount;
+        root = child;
+    }
+}
+
+template <typename T, typename Proj = Identity>
+void heapSort(T *array, const int &size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    for (int i = size / 2 - 1; i >= 0; i--)
+    {
+        siftDown(array, i, size, step, swapCount, proj);
+    }
+    for (int last = size - 1; last > 0; last--)
+    {
+        swapElements(array[0], array[last]);
+        ++swapCount;
+        siftDown(array, 0, last, step, swapCount, proj);
+    }
+}
+
+template <typename T, typename Proj = Identity>
+void introSortLoop(T *array, int start, int end, int depthLimit, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    while (end - start + 1 > SMALL_SORT_THRESHOLD)
+    {
+        if (depthLimit == 0)
+        {
+            heapSort(array + start, end - start + 1, step, swapCount, proj);
+            return;
+        }
+        --depthLimit;
+
+        int i, j;
+        hoarePartition(array, start, end, i, j, step, swapCount, proj);
+
+        // Recurse into the smaller side and keep looping on the larger one,
+        // so the stack never holds more than log2(n) frames
+        if (i - 1 - start < end - j - 1)
+        {
+            introSortLoop(array, start, i - 1, depthLimit, step, swapCount, proj);
+            start = j + 1;
+        }
+        else
+        {
+            introSortLoop(array, j + 1, end, depthLimit, step, swapCount, proj);
+            end = i - 1;
+        }
+    }
+
+    networkSortUpTo<SMALL_SORT_THRESHOLD>(array + start, end - start + 1, step, swapCount, proj);
+}
+
+// quickSort with a recursion budget of 2*log2(n); partitions that exceed it
+// fall back to heapSort, so the worst case stays O(n log n)
+template <typename T, typename Proj = Identity>
+void introSort(T *array, int start, int end, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    int depthLimit = 0;
+    for (int n = end - start + 1; n > 1; n >>= 1)
+    {
+        depthLimit += 2;
+    }
+    introSortLoop(array, start, end, depthLimit, step, swapCount, proj);
+}
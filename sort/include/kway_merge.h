@@ -0,0 +1,208 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "basic_sort.h"
+#include "int_io.h"
+#include "loser_tree.h"
+
+// Source over a sorted in-memory array
+template <typename T>
+class ArraySource
+{
+private:
+    const T *next_;
+    const T *end_;
+
+public:
+    ArraySource(const T *array, const int &size) : next_(array), end_(array + size) {}
+
+    bool next(T &value)
+    {
+        if (next_ == end_)
+        {
+            return false;
+        }
+        value = *next_++;
+        return true;
+    }
+};
+
+// Owning handle of a run file, closed however the merge ends
+using RunFile = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+inline RunFile openRunFile(const std::string &path, const char *mode)
+{
+    RunFile file(std::fopen(path.c_str(), mode), &std::fclose);
+    if (file == nullptr)
+    {
+        throw std::runtime_error("k-way merge: cannot open " + path);
+    }
+    return file;
+}
+
+// Closes file; buffered data that could not be written is an error here
+inline void closeRunFile(RunFile &file)
+{
+    if (std::fclose(file.release()) != 0)
+    {
+        throw std::runtime_error("k-way merge: failed to close run file");
+    }
+}
+
+// Sequential reader of a binary run file through a large buffer; the file is
+// a raw little-endian array, the binary format of int_io.h
+template <typename T>
+class RunReader
+{
+private:
+    std::FILE *file_;
+    std::vector<T> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t size_ = 0;
+
+public:
+    RunReader(std::FILE *file, std::size_t blockSize) : file_(file), buffer_(blockSize) {}
+
+    bool next(T &value)
+    {
+        if (pos_ == size_)
+        {
+            size_ = std::fread(buffer_.data(), sizeof(T), buffer_.size(), file_);
+            pos_ = 0;
+            // A short read is the end of the run only if nothing failed
+            if (size_ < buffer_.size() && std::ferror(file_))
+            {
+                throw std::runtime_error("k-way merge: failed to read run file");
+            }
+            if (size_ == 0)
+            {
+                return false;
+            }
+            if (!hostIsLittleEndian())
+            {
+                for (std::size_t i = 0; i < size_; i++)
+                {
+                    buffer_[i] = byteSwap(buffer_[i]);
+                }
+            }
+        }
+        value = buffer_[pos_++];
+        return true;
+    }
+};
+
+// Buffered writer of a binary run file in the format RunReader reads;
+// flush() must be called once at the end
+template <typename T>
+class RunWriter
+{
+private:
+    std::FILE *file_;
+    std::vector<T> buffer_;
+
+public:
+    RunWriter(std::FILE *file, std::size_t blockSize) : file_(file)
+    {
+        buffer_.reserve(blockSize);
+    }
+
+    void operator()(const T &value)
+    {
+        buffer_.push_back(value);
+        if (buffer_.size() == buffer_.capacity())
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!hostIsLittleEndian())
+        {
+            for (T &x : buffer_)
+            {
+                x = byteSwap(x);
+            }
+        }
+        if (!buffer_.empty() && std::fwrite(buffer_.data(), sizeof(T), buffer_.size(), file_) != buffer_.size())
+        {
+            throw std::runtime_error("k-way merge: failed to write run file");
+        }
+        buffer_.clear();
+    }
+};
+
+// Merges sorted sources into sink through a loser tree, one comparison per
+// tree level for every element. A source is anything with bool next(T &),
+// e.g. ArraySource or RunReader. Equal keys keep the order of their sources.
+template <typename T, typename Source, typename Sink>
+void kWayMerge(std::vector<Source> &sources, Sink &sink, SortCount &step, SortCount &swapCount)
+{
+    LoserTree<T> tree(static_cast<int>(sources.size()));
+    for (std::size_t i = 0; i < sources.size(); i++)
+    {
+        T value;
+        if (sources[i].next(value))
+        {
+            tree.setKey(static_cast<int>(i), value);
+        }
+    }
+    tree.build();
+
+    while (!tree.empty())
+    {
+        sink(tree.top());
+        ++swapCount;
+
+        T value;
+        if (sources[tree.winner()].next(value))
+        {
+            tree.replaceTop(value);
+        }
+        else
+        {
+            tree.popTop();
+        }
+    }
+    step += tree.step();
+}
+
+// Merges sorted arrays into out, which must hold the sum of their sizes
+template <typename T>
+void kWayMerge(const std::vector<const T *> &arrays, const std::vector<int> &sizes, T *out, SortCount &step, SortCount &swapCount)
+{
+    std::vector<ArraySource<T>> sources;
+    sources.reserve(arrays.size());
+    for (std::size_t i = 0; i < arrays.size(); i++)
+    {
+        sources.emplace_back(arrays[i], sizes[i]);
+    }
+    auto sink = [&out](const T &x) { *out++ = x; };
+    kWayMerge<T>(sources, sink, step, swapCount);
+}
+
+// Merges sorted binary files of T (raw little-endian arrays, as written by
+// writeBinary of int_io.h) into output in the same format. Every input and the
+// output get a buffer of blockSize values.
+template <typename T>
+void kWayMergeFiles(const std::vector<std::string> &inputs, const std::string &output, std::size_t blockSize, SortCount &step, SortCount &swapCount)
+{
+    std::vector<RunFile> files;
+    std::vector<RunReader<T>> readers;
+    files.reserve(inputs.size());
+    readers.reserve(inputs.size());
+    for (const std::string &path : inputs)
+    {
+        files.push_back(openRunFile(path, "rb"));
+        readers.emplace_back(files.back().get(), blockSize);
+    }
+    RunFile out = openRunFile(output, "wb");
+    RunWriter<T> writer(out.get(), blockSize);
+    kWayMerge<T>(readers, writer, step, swapCount);
+    writer.flush();
+    closeRunFile(out);
+}
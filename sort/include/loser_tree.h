@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include "basic_sort.h"
+
+// Tournament tree over k sources that keeps the loser of every match in the
+// internal nodes. Replacing the winner replays only its leaf-to-root path, one
+// comparison per level. Ties go to the lower source index, so merges are stable.
+template <typename T>
+class LoserTree
+{
+private:
+    int size_;
+    std::vector<int> tree_; // tree_[0] is the winner, tree_[1..k-1] the losers
+    std::vector<T> keys_;
+    std::vector<char> exhausted_;
+    SortCount step_ = 0;
+
+    // Orders sources by (exhausted, key, index); written without early exits
+    // so that the compiler can evaluate it with flag arithmetic instead of
+    // branches that mispredict on random keys
+    bool less(const int &a, const int &b)
+    {
+        ++step_;
+        bool aDone = exhausted_[a];
+        bool bDone = exhausted_[b];
+        bool keyLess = keys_[a] < keys_[b];
+        bool keyEqual = !(keys_[b] < keys_[a]) & !keyLess;
+        return (aDone < bDone) | ((aDone == bDone) & (keyLess | (keyEqual & (a < b))));
+    }
+
+    // Leaves are nodes k..2k-1; returns the winner of the subtree at node
+    int build(const int &node)
+    {
+        if (node >= size_)
+        {
+            return node - size_;
+        }
+        int left = build(2 * node);
+        int right = build(2 * node + 1);
+        if (less(right, left))
+        {
+            tree_[node] = left;
+            return right;
+        }
+        tree_[node] = right;
+        return left;
+    }
+
+    void replay(int winner)
+    {
+        for (int node = (winner + size_) / 2; node > 0; node /= 2)
+        {
+            int loser = tree_[node];
+            bool swap = less(loser, winner);
+            tree_[node] = swap ? winner : loser;
+            winner = swap ? loser : winner;
+        }
+        tree_[0] = winner;
+    }
+
+public:
+    explicit LoserTree(int size) : size_(size), tree_(size), keys_(size), exhausted_(size, true) {}
+
+    int size() const
+    {
+        return size_;
+    }
+
+    // Initial key of a source; sources that never get one count as empty
+    void setKey(const int &source, const T &key)
+    {
+        keys_[source] = key;
+        exhausted_[source] = false;
+    }
+
+    // Plays the first tournament once every initial key has been set
+    void build()
+    {
+        if (size_ > 0)
+        {
+            tree_[0] = size_ > 1 ? build(1) : 0;
+        }
+    }
+
+    bool empty() const
+    {
+        return size_ == 0 || exhausted_[tree_[0]];
+    }
+
+    int winner() const
+    {
+        return tree_[0];
+    }
+
+    const T &top() const
+    {
+        return keys_[tree_[0]];
+    }
+
+    // The winning source produced its next key
+    void replaceTop(const T &key)
+    {
+        keys_[tree_[0]] = key;
+        replay(tree_[0]);
+    }
+
+    // The winning source ran dry
+    void popTop()
+    {
+        exhausted_[tree_[0]] = true;
+        replay(tree_[0]);
+    }
+
+    // Matches played so far
+    SortCount step() const
+    {
+        return step_;
+    }
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "basic_sort.h"
+#include "parallel_quick_sort.h"
+#include "tim_sort.h"
+#include "work_stealing_pool.h"
+
+// Arrays shorter than this are sorted by timSort on the calling thread
+constexpr int PARALLEL_MERGE_SORT_CUTOFF = 1 << 16;
+
+// Number of elements of a that come first among the first d outputs of the
+// stable merge of a and b (ties go to a)
+template <typename T, typename Proj>
+int coRank(const int &d, const T *a, const int &aSize, const T *b, const int &bSize, SortCount &step, Proj &proj)
+{
+    int lo = std::max(0, d - bSize);
+    int hi = std::min(d, aSize);
+    while (lo < hi)
+    {
+        int i = lo + (hi - lo) / 2;
+        ++step;
+        // a[i] <= b[d-i-1] means a[i] must be among the first d as well
+        if (!lessBy(proj, b[d - i - 1], a[i]))
+        {
+            lo = i + 1;
+        }
+        else
+        {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+// Stable merge of a and b into out, moving the elements
+template <typename T, typename Proj>
+void moveMerge(T *a, T *aEnd, T *b, T *bEnd, T *out, SortCount &step, SortCount &swapCount, Proj &proj)
+{
+    swapCount += (aEnd - a) + (bEnd - b);
+    while (a != aEnd && b != bEnd)
+    {
+        ++step;
+        if (lessBy(proj, *b, *a))
+        {
+            *out++ = std::move(*b++);
+        }
+        else
+        {
+            *out++ = std::move(*a++);
+        }
+    }
+    out = std::move(a, aEnd, out);
+    std::move(b, bEnd, out);
+}
+
+// Stable parallel merge sort for records.
+// Each worker timSorts one chunk, then the runs are merged pairwise in rounds
+// that alternate between array and a buffer. Every merge is cut into equal
+// output slices by co-ranking, so all workers stay busy in the last rounds too.
+template <typename T, typename Proj = Identity>
+void parallelMergeSort(WorkStealingPool &pool, T *array, int size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    int threads = pool.size();
+    if (size < PARALLEL_MERGE_SORT_CUTOFF || threads < 2)
+    {
+        timSort(array, size, step, swapCount, proj);
+        return;
+    }
+
+    std::vector<SortCounter> counters(threads);
+    std::vector<int> bounds;
+    for (int c = 0; c <= threads; c++)
+    {
+        bounds.push_back(static_cast<int>(static_cast<long long>(size) * c / threads));
+    }
+
+    pool.run([&] {
+        for (int c = 0; c < threads; c++)
+        {
+            pool.spawn([&, c] {
+                SortCounter &counter = counters[pool.workerIndex()];
+                timSort(array + bounds[c], bounds[c + 1] - bounds[c], counter.step, counter.swapCount, proj);
+            });
+        }
+    });
+
+    std::vector<T> buffer(size);
+    T *src = array;
+    T *dst = buffer.data();
+    while (bounds.size() > 2)
+    {
+        int merges = static_cast<int>(bounds.size()) / 2;
+        int slices = std::max(1, threads / merges);
+        std::vector<int> next;
+
+        pool.run([&] {
+            for (std::size_t r = 0; r + 1 < bounds.size(); r += 2)
+            {
+                int start = bounds[r];
+                int mid = bounds[r + 1];
+                int end = r + 2 < bounds.size() ? bounds[r + 2] : mid;
+                for (int s = 0; s < slices; s++)
+                {
+                    pool.spawn([&, start, mid, end, s] {
+                        SortCounter &counter = counters[pool.workerIndex()];
+                        T *a = src + start;
+                        T *b = src + mid;
+                        int aSize = mid - start;
+                        int bSize = end - mid;
+                        int from = static_cast<int>(static_cast<long long>(aSize + bSize) * s / slices);
+                        int to = static_cast<int>(static_cast<long long>(aSize + bSize) * (s + 1) / slices);
+                        int i0 = coRank(from, a, aSize, b, bSize, counter.step, proj);
+                        int i1 = coRank(to, a, aSize, b, bSize, counter.step, proj);
+                        moveMerge(a + i0, a + i1, b + from - i0, b + to - i1, dst + start + from,
+                                  counter.step, counter.swapCount, proj);
+                    });
+                }
+            }
+        });
+
+        for (std::size_t r = 0; r < bounds.size(); r += 2)
+        {
+            next.push_back(bounds[r]);
+        }
+        if (next.back() != size)
+        {
+            next.push_back(size);
+        }
+        bounds.swap(next);
+        std::swap(src, dst);
+    }
+
+    if (src != array)
+    {
+        pool.run([&] {
+            for (int c = 0; c < threads; c++)
+            {
+                pool.spawn([&, c] {
+                    int start = static_cast<int>(static_cast<long long>(size) * c / threads);
+                    int end = static_cast<int>(static_cast<long long>(size) * (c + 1) / threads);
+                    std::move(src + start, src + end, array + start);
+                    counters[pool.workerIndex()].swapCount += end - start;
+                });
+            }
+        });
+    }
+
+    for (const SortCounter &counter : counters)
+    {
+        step += counter.step;
+        swapCount += counter.swapCount;
+    }
+}
+
+template <typename T, typename Proj = Identity>
+void parallelMergeSort(T *array, int size, SortCount &step, SortCount &swapCount, int threadCount, Proj proj = Proj())
+{
+    WorkStealingPool pool(threadCount);
+    parallelMergeSort(pool, array, size, step, swapCount, proj);
+}
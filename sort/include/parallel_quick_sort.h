@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include "basic_sort.h"
+#include "work_stealing_pool.h"
+
+// Ranges shorter than this are sorted serially by the worker that owns them
+constexpr int PARALLEL_SORT_CUTOFF = 1 << 14;
+
+// Per-worker statistics, padded so neighbouring workers do not share a cache line
+struct alignas(64) SortCounter
+{
+    SortCount step = 0;
+    SortCount swapCount = 0;
+};
+
+template <typename T>
+void parallelQuickSortTask(WorkStealingPool &pool, std::vector<SortCounter> &counters, T *array, int start, int end, int cutoff)
+{
+    SortCounter &counter = counters[pool.workerIndex()];
+    if (end - start < cutoff)
+    {
+        quickSort(array, start, end, counter.step, counter.swapCount);
+        return;
+    }
+
+    int i, j;
+    hoarePartition(array, start, end, i, j, counter.step, counter.swapCount);
+
+    pool.spawn([&pool, &counters, array, start, i, cutoff] {
+        parallelQuickSortTask(pool, counters, array, start, i - 1, cutoff);
+    });
+    pool.spawn([&pool, &counters, array, j, end, cutoff] {
+        parallelQuickSortTask(pool, counters, array, j + 1, end, cutoff);
+    });
+}
+
+// Same result and statistics as quickSort, with both halves of every partition
+// above the cutoff handed to the workers of the pool
+template <typename T>
+void parallelQuickSort(WorkStealingPool &pool, T *array, int start, int end, SortCount &step, SortCount &swapCount, int cutoff = PARALLEL_SORT_CUTOFF)
+{
+    std::vector<SortCounter> counters(pool.size());
+    pool.run([&pool, &counters, array, start, end, cutoff] {
+        parallelQuickSortTask(pool, counters, array, start, end, cutoff);
+    });
+
+    for (const SortCounter &counter : counters)
+    {
+        step += counter.step;
+        swapCount += counter.swapCount;
+    }
+}
+
+template <typename T>
+void parallelQuickSort(T *array, int start, int end, SortCount &step, SortCount &swapCount, int threadCount, int cutoff = PARALLEL_SORT_CUTOFF)
+{
+    WorkStealingPool pool(threadCount);
+    parallelQuickSort(pool, array, start, end, step, swapCount, cutoff);
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "basic_sort.h"
+#include "intro_sort.h"
+#include "parallel_quick_sort.h"
+#include "work_stealing_pool.h"
+
+// Arrays shorter than this are sorted by introSort on the calling thread
+constexpr int PARALLEL_SAMPLE_SORT_CUTOFF = 1 << 16;
+// Buckets per worker and sample elements per bucket
+constexpr int SAMPLE_SORT_BUCKETS_PER_THREAD = 4;
+constexpr int SAMPLE_SORT_OVERSAMPLING = 16;
+
+// Bucket of x for sorted, duplicate-free splitters: bucket 2b holds the keys
+// strictly between splitter b-1 and splitter b, bucket 2b-1 the keys equal to
+// splitter b-1. Equal buckets never need sorting, which keeps inputs with few
+// distinct keys from piling into one bucket.
+template <typename T, typename Proj>
+int findBucket(const std::vector<T> &splitters, const T &x, SortCount &step, Proj &proj)
+{
+    int lo = 0;
+    int hi = static_cast<int>(splitters.size());
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        ++step;
+        if (lessBy(proj, x, splitters[mid]))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    ++step;
+    return lo > 0 && !lessBy(proj, splitters[lo - 1], x) ? 2 * lo - 1 : 2 * lo;
+}
+
+// Parallel sample sort.
+// Splitters are picked from an oversampled random sample, every worker classifies
+// one chunk and counts its buckets, the chunks are scattered into a buffer at
+// offsets from the prefix sums, and then the buckets are sorted in parallel by
+// introSort and moved back. Needs one buffer of size elements.
+template <typename T, typename Proj = Identity>
+void parallelSampleSort(WorkStealingPool &pool, T *array, int size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    int threads = pool.size();
+    if (size < PARALLEL_SAMPLE_SORT_CUTOFF || threads < 2)
+    {
+        introSort(array, 0, size - 1, step, swapCount, proj);
+        return;
+    }
+
+    // Splitters
+    int bucketCount = threads * SAMPLE_SORT_BUCKETS_PER_THREAD;
+    std::vector<T> splitters;
+    {
+        std::mt19937 engine(size);
+        std::uniform_int_distribution<int> dist(0, size - 1);
+        std::vector<T> sample;
+        sample.reserve(bucketCount * SAMPLE_SORT_OVERSAMPLING);
+        for (int i = 0; i < bucketCount * SAMPLE_SORT_OVERSAMPLING; i++)
+        {
+            sample.push_back(array[dist(engine)]);
+        }
+        introSort(sample.data(), 0, static_cast<int>(sample.size()) - 1, step, swapCount, proj);
+        for (int i = 1; i < bucketCount; i++)
+        {
+            const T &candidate = sample[i * SAMPLE_SORT_OVERSAMPLING];
+            if (splitters.empty() || lessBy(proj, splitters.back(), candidate))
+            {
+                splitters.push_back(candidate);
+            }
+        }
+    }
+    int buckets = 2 * static_cast<int>(splitters.size()) + 1;
+
+    // Classification: one chunk per worker
+    int chunks = threads;
+    int chunkSize = (size + chunks - 1) / chunks;
+    std::vector<std::uint16_t> bucketOf(size);
+    std::vector<std::vector<int>> counts(chunks, std::vector<int>(buckets, 0));
+    std::vector<SortCounter> counters(threads);
+
+    pool.run([&] {
+        for (int c = 0; c < chunks; c++)
+        {
+            pool.spawn([&, c] {
+                SortCounter &counter = counters[pool.workerIndex()];
+                int end = std::min(size, (c + 1) * chunkSize);
+                for (int i = c * chunkSize; i < end; i++)
+                {
+                    int b = findBucket(splitters, array[i], counter.step, proj);
+                    bucketOf[i] = static_cast<std::uint16_t>(b);
+                    ++counts[c][b];
+                }
+            });
+        }
+    });
+
+    // Offsets: bucket by bucket, and within a bucket chunk by chunk
+    std::vector<int> bucketStart(buckets + 1, 0);
+    std::vector<std::vector<int>> offsets(chunks, std::vector<int>(buckets));
+    int offset = 0;
+    for (int b = 0; b < buckets; b++)
+    {
+        bucketStart[b] = offset;
+        for (int c = 0; c < chunks; c++)
+        {
+            offsets[c][b] = offset;
+            offset += counts[c][b];
+        }
+    }
+    bucketStart[buckets] = size;
+
+    // Scatter, then sort every non-equal bucket and move it back
+    std::vector<T> buffer(size);
+    pool.run([&] {
+        for (int c = 0; c < chunks; c++)
+        {
+            pool.spawn([&, c] {
+                SortCounter &counter = counters[pool.workerIndex()];
+                std::vector<int> &next = offsets[c];
+                int end = std::min(size, (c + 1) * chunkSize);
+                for (int i = c * chunkSize; i < end; i++)
+                {
+                    buffer[next[bucketOf[i]]++] = std::move(array[i]);
+                }
+                counter.swapCount += end - c * chunkSize;
+            });
+        }
+    });
+
+    pool.run([&] {
+        for (int b = 0; b < buckets; b++)
+        {
+            pool.spawn([&, b] {
+                SortCounter &counter = counters[pool.workerIndex()];
+                int start = bucketStart[b];
+                int end = bucketStart[b + 1];
+                if (b % 2 == 0)
+                {
+                    introSort(buffer.data(), start, end - 1, counter.step, counter.swapCount, proj);
+                }
+                std::move(buffer.begin() + start, buffer.begin() + end, array + start);
+                counter.swapCount += end - start;
+            });
+        }
+    });
+
+    for (const SortCounter &counter : counters)
+    {
+        step += counter.step;
+        swapCount += counter.swapCount;
+    }
+}
+
+template <typename T, typename Proj = Identity>
+void parallelSampleSort(T *array, int size, SortCount &step, SortCount &swapCount, int threadCount, Proj proj = Proj())
+{
+    WorkStealingPool pool(threadCount);
+    parallelSampleSort(pool, array, size, step, swapCount, proj);
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+// Hardware performance counters around a sort invocation.
+// Enabled by building with -DSORT_PERF_COUNTERS (cmake -DSORT_PERF_COUNTERS=ON)
+// on Linux; otherwise PerfCounters is empty and measureSort only runs the sort.
+
+struct PerfSample
+{
+    long long cycles = 0;
+    long long instructions = 0;
+    long long cacheMisses = 0;
+    long long branchMisses = 0;
+    bool valid = false;
+};
+
+#if defined(SORT_PERF_COUNTERS) && defined(__linux__)
+
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// User-space cycles, instructions, cache misses and branch misses of the
+// calling thread and of every thread it creates while the counters are open.
+// Each event is opened with inherit = 1 and read on its own, since the kernel
+// refuses group reads of inherited events. Threads that already exist when
+// the counters are opened are not counted, so open them before starting a
+// long-lived pool.
+class PerfCounters
+{
+private:
+    static constexpr int EventCount = 4;
+    int fds_[EventCount] = {-1, -1, -1, -1};
+
+    static int openEvent(const unsigned long long &config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+public:
+    PerfCounters()
+    {
+        const unsigned long long configs[EventCount] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int i = 0; i < EventCount; i++)
+        {
+            fds_[i] = openEvent(configs[i]);
+            if (fds_[i] < 0)
+            {
+                close();
+                return;
+            }
+        }
+    }
+
+    ~PerfCounters()
+    {
+        close();
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    void close()
+    {
+        for (int &fd : fds_)
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+            fd = -1;
+        }
+    }
+
+    void start()
+    {
+        if (fds_[0] < 0)
+        {
+            return;
+        }
+        for (int fd : fds_)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        }
+        for (int fd : fds_)
+        {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    // Invalid when the kernel refused the events (e.g. perf_event_paranoid, containers)
+    PerfSample stop()
+    {
+        PerfSample sample;
+        if (fds_[0] < 0)
+        {
+            return sample;
+        }
+        for (int fd : fds_)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+
+        // A read adds up the counts of all inherited threads, running or exited
+        unsigned long long values[EventCount];
+        for (int i = 0; i < EventCount; i++)
+        {
+            if (read(fds_[i], &values[i], sizeof(values[i])) != static_cast<ssize_t>(sizeof(values[i])))
+            {
+                return sample;
+            }
+        }
+        sample.cycles = static_cast<long long>(values[0]);
+        sample.instructions = static_cast<long long>(values[1]);
+        sample.cacheMisses = static_cast<long long>(values[2]);
+        sample.branchMisses = static_cast<long long>(values[3]);
+        sample.valid = true;
+        return sample;
+    }
+};
+
+#else
+
+class PerfCounters
+{
+public:
+    void start() {}
+
+    PerfSample stop()
+    {
+        return PerfSample();
+    }
+};
+
+#endif
+
+// Runs sort() between start and stop of fresh counters; threads the sort
+// spawns (and joins) are included
+template <typename F>
+PerfSample measureSort(F &&sort)
+{
+    PerfCounters counters;
+    counters.start();
+    sort();
+    return counters.stop();
+}
+
+// Runs sort() between start and stop of counters that outlive it; threads
+// created after the counters were opened, e.g. a pool kept across trials,
+// are included
+template <typename F>
+PerfSample measureSort(PerfCounters &counters, F &&sort)
+{
+    counters.start();
+    sort();
+    return counters.stop();
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "basic_sort.h"
+
+// Maps a value to an unsigned key whose unsigned order matches the value order
+template <typename T, typename Enable = void>
+struct RadixKey;
+
+template <typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type>
+{
+    using Key = T;
+
+    static Key toKey(const T &x)
+    {
+        return x;
+    }
+};
+
+// Signed integers: flipping the sign bit moves negatives below positives
+template <typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+{
+    using Key = typename std::make_unsigned<T>::type;
+
+    static Key toKey(const T &x)
+    {
+        return static_cast<Key>(x) ^ (Key(1) << (sizeof(Key) * 8 - 1));
+    }
+};
+
+// IEEE floating point: negatives have every bit flipped, positives only the sign bit
+template <typename T>
+struct RadixKey<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "RadixKey supports 32 and 64 bit floating point only");
+    using Key = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+
+    static Key toKey(const T &x)
+    {
+        Key bits;
+        std::memcpy(&bits, &x, sizeof(Key));
+        const Key signBit = Key(1) << (sizeof(Key) * 8 - 1);
+        return (bits & signBit) ? ~bits : (bits | signBit);
+    }
+};
+
+// LSD radix sort, one byte per pass.
+// All byte histograms are built in a single sweep and passes whose byte is the
+// same for every key are skipped. step counts element reads, swapCount element moves.
+template <typename T>
+void radixSort(T *array, int size, SortCount &step, SortCount &swapCount)
+{
+    using Traits = RadixKey<T>;
+    using Key = typename Traits::Key;
+    constexpr int Passes = sizeof(Key);
+
+    if (size < 2)
+    {
+        return;
+    }
+
+    std::vector<std::array<int, 256>> histograms(Passes);
+    for (auto &histogram : histograms)
+    {
+        histogram.fill(0);
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        Key key = Traits::toKey(array[i]);
+        for (int pass = 0; pass < Passes; pass++)
+        {
+            ++histograms[pass][(key >> (pass * 8)) & 0xff];
+        }
+    }
+    step += size;
+
+    std::vector<T> buffer(size);
+    T *src = array;
+    T *dst = buffer.data();
+
+    for (int pass = 0; pass < Passes; pass++)
+    {
+        std::array<int, 256> &histogram = histograms[pass];
+        int shift = pass * 8;
+        if (histogram[(Traits::toKey(array[0]) >> shift) & 0xff] == size)
+        {
+            continue;
+        }
+
+        int offset = 0;
+        for (int &count : histogram)
+        {
+            int tmp = count;
+            count = offset;
+            offset += tmp;
+        }
+
+        for (int i = 0; i < size; i++)
+        {
+            dst[histogram[(Traits::toKey(src[i]) >> shift) & 0xff]++] = src[i];
+        }
+        step += size;
+        swapCount += size;
+
+        T *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != array)
+    {
+        std::memcpy(array, src, sizeof(T) * size);
+        swapCount += size;
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "basic_sort.h"
+#include "intro_sort.h"
+
+// Selects the k smallest of array[start..end] with a max-heap over
+// array[start..nth], leaving the largest of them at array[nth]
+template <typename T, typename Proj = Identity>
+void heapSelect(T *array, int start, int end, int nth, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    T *heap = array + start;
+    int k = nth - start + 1;
+    for (int i = k / 2 - 1; i >= 0; i--)
+    {
+        siftDown(heap, i, k, step, swapCount, proj);
+    }
+    for (int i = nth + 1; i <= end; i++)
+    {
+        ++step;
+        if (lessBy(proj, array[i], heap[0]))
+        {
+            swapElements(array[i], heap[0]);
+            ++swapCount;
+            siftDown(heap, 0, k, step, swapCount, proj);
+        }
+    }
+    swapElements(heap[0], array[nth]);
+    ++swapCount;
+}
+
+// Introselect: rearranges array[start..end] so that array[nth] holds the
+// element a full sort would put there, with nothing greater before it and
+// nothing smaller after it. Quickselect on hoarePartition, falling back to
+// heapSelect after 2*log2(n) partitions that did not shrink the range enough.
+template <typename T, typename Proj = Identity>
+void nthElement(T *array, int start, int end, int nth, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    int depthLimit = 0;
+    for (int n = end - start + 1; n > 1; n >>= 1)
+    {
+        depthLimit += 2;
+    }
+
+    while (end - start + 1 > SMALL_SORT_THRESHOLD)
+    {
+        if (depthLimit == 0)
+        {
+            heapSelect(array, start, end, nth, step, swapCount, proj);
+            return;
+        }
+        --depthLimit;
+
+        int i, j;
+        hoarePartition(array, start, end, i, j, step, swapCount, proj);
+        if (nth < i)
+        {
+            end = i - 1;
+        }
+        else if (nth > j)
+        {
+            start = j + 1;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    networkSortUpTo<SMALL_SORT_THRESHOLD>(array + start, end - start + 1, step, swapCount, proj);
+}
+
+// Sorts the k smallest elements into array[0..k-1]; the rest is left unordered
+template <typename T, typename Proj = Identity>
+void partialSort(T *array, int size, int k, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    if (k <= 0 || size <= 0)
+    {
+        return;
+    }
+    if (k > size)
+    {
+        k = size;
+    }
+    nthElement(array, 0, size - 1, k - 1, step, swapCount, proj);
+    introSort(array, 0, k - 2, step, swapCount, proj);
+}
+
+// The k smallest values of a stream, kept in a bounded max-heap, so memory is
+// O(k) however long the input is. Each push costs O(log k) at most.
+template <typename T, typename Proj = Identity>
+class TopK
+{
+private:
+    int k_;
+    std::vector<T> heap_;
+    Proj proj_;
+    SortCount step_ = 0;
+    SortCount swapCount_ = 0;
+
+    void siftUp(int child)
+    {
+        while (child > 0)
+        {
+            int parent = (child - 1) / 2;
+            ++step_;
+            if (!lessBy(proj_, heap_[parent], heap_[child]))
+            {
+                return;
+            }
+            swapElements(heap_[parent], heap_[child]);
+            ++swapCount_;
+            child = parent;
+        }
+    }
+
+public:
+    explicit TopK(int k, Proj proj = Proj()) : k_(k), proj_(proj)
+    {
+        heap_.reserve(k);
+    }
+
+    void push(T x)
+    {
+        if (k_ <= 0)
+        {
+            return;
+        }
+        if (static_cast<int>(heap_.size()) < k_)
+        {
+            heap_.push_back(std::move(x));
+            siftUp(static_cast<int>(heap_.size()) - 1);
+            return;
+        }
+        ++step_;
+        if (lessBy(proj_, x, heap_[0]))
+        {
+            heap_[0] = std::move(x);
+            ++swapCount_;
+            siftDown(heap_.data(), 0, k_, step_, swapCount_, proj_);
+        }
+    }
+
+    int size() const
+    {
+        return static_cast<int>(heap_.size());
+    }
+
+    // Largest of the current k smallest
+    const T &top() const
+    {
+        return heap_[0];
+    }
+
+    // The k smallest in ascending order
+    std::vector<T> sorted()
+    {
+        std::vector<T> result(heap_);
+        introSort(result.data(), 0, static_cast<int>(result.size()) - 1, step_, swapCount_, proj_);
+        return result;
+    }
+
+    SortCount step() const
+    {
+        return step_;
+    }
+
+    SortCount swapCount() const
+    {
+        return swapCount_;
+    }
+};
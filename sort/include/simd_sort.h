@@ -0,0 +1,411 @@
+#pragma once
+#include <array>
+#include <limits>
+#include "basic_sort.h"
+#include "intro_sort.h"
+
+// AVX2 quick sort for int and double arrays.
+// Partitions use vector compares and a permutation table to pack the keys below
+// the pivot to one end of each vector; ranges of up to 16 keys are finished with
+// in-register bitonic networks. CPUs without AVX2 (and non-x86 builds) use introSort.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_SORT_HAS_AVX2 1
+#include <immintrin.h>
+#define SIMD_SORT_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_SORT_HAS_AVX2 0
+#endif
+
+inline bool hasAvx2()
+{
+#if SIMD_SORT_HAS_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#if SIMD_SORT_HAS_AVX2
+
+// Lane indices that move the lanes set in mask to the front, keeping their order.
+// Every lane is LaneWidth 32-bit words wide.
+template <int Lanes, int LaneWidth>
+constexpr std::array<std::array<int, 8>, (1 << Lanes)> makeCompressTable()
+{
+    std::array<std::array<int, 8>, (1 << Lanes)> table{};
+    for (int mask = 0; mask < (1 << Lanes); mask++)
+    {
+        int k = 0;
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int lane = 0; lane < Lanes; lane++)
+            {
+                if (((mask >> lane) & 1) == (pass == 0 ? 1 : 0))
+                {
+                    for (int w = 0; w < LaneWidth; w++)
+                    {
+                        table[mask][k++] = lane * LaneWidth + w;
+                    }
+                }
+            }
+        }
+    }
+    return table;
+}
+
+// Blend mask of one bitonic compare-exchange step: lane i pairs with lane i^J
+// and takes the maximum when it is the upper lane of an ascending pair or the
+// lower lane of a descending pair (blocks of K lanes alternate direction)
+constexpr int bitonicMaxMask(int lanes, int j, int k)
+{
+    int mask = 0;
+    for (int i = 0; i < lanes; i++)
+    {
+        if (((i & j) != 0) != ((i & k) != 0))
+        {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+struct Avx2Int
+{
+    using Value = int;
+    using Vec = __m256i;
+    static constexpr int Lanes = 8;
+    static constexpr int NetworkSize = 16;
+
+    SIMD_SORT_AVX2 static Vec load(const int *p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    SIMD_SORT_AVX2 static void store(int *p, const Vec &v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+
+    SIMD_SORT_AVX2 static Vec set1(const int &x)
+    {
+        return _mm256_set1_epi32(x);
+    }
+
+    // Bit i set when lane i belongs left of the pivot
+    SIMD_SORT_AVX2 static int leftMask(const Vec &v, const Vec &pivot, bool lessEqual)
+    {
+        Vec m = lessEqual ? _mm256_cmpgt_epi32(v, pivot) : _mm256_cmpgt_epi32(pivot, v);
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        return lessEqual ? (~bits & 0xff) : bits;
+    }
+
+    SIMD_SORT_AVX2 static Vec compress(const Vec &v, int mask)
+    {
+        static constexpr auto Table = makeCompressTable<8, 1>();
+        return _mm256_permutevar8x32_epi32(v, load(Table[mask].data()));
+    }
+
+    template <int J, int K, int Mask = bitonicMaxMask(8, J, K)>
+    SIMD_SORT_AVX2 static Vec step(const Vec &v)
+    {
+        Vec partner = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0 ^ J, 1 ^ J, 2 ^ J, 3 ^ J, 4 ^ J, 5 ^ J, 6 ^ J, 7 ^ J));
+        return _mm256_blend_epi32(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), Mask);
+    }
+
+    SIMD_SORT_AVX2 static Vec merge8(Vec v)
+    {
+        v = step<4, 8>(v);
+        v = step<2, 8>(v);
+        return step<1, 8>(v);
+    }
+
+    SIMD_SORT_AVX2 static Vec sort8(Vec v)
+    {
+        v = step<1, 2>(v);
+        v = step<2, 4>(v);
+        v = step<1, 4>(v);
+        return merge8(v);
+    }
+
+    SIMD_SORT_AVX2 static void sortNetwork(int *array, int size)
+    {
+        alignas(32) int buffer[16];
+        for (int i = 0; i < 16; i++)
+        {
+            buffer[i] = i < size ? array[i] : std::numeric_limits<int>::max();
+        }
+        Vec a = sort8(load(buffer));
+        Vec b = sort8(load(buffer + 8));
+        b = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        store(buffer, merge8(_mm256_min_epi32(a, b)));
+        store(buffer + 8, merge8(_mm256_max_epi32(a, b)));
+        for (int i = 0; i < size; i++)
+        {
+            array[i] = buffer[i];
+        }
+    }
+};
+
+struct Avx2Double
+{
+    using Value = double;
+    using Vec = __m256d;
+    static constexpr int Lanes = 4;
+    static constexpr int NetworkSize = 16;
+
+    SIMD_SORT_AVX2 static Vec load(const double *p)
+    {
+        return _mm256_loadu_pd(p);
+    }
+
+    SIMD_SORT_AVX2 static void store(double *p, const Vec &v)
+    {
+        _mm256_storeu_pd(p, v);
+    }
+
+    SIMD_SORT_AVX2 static Vec set1(const double &x)
+    {
+        return _mm256_set1_pd(x);
+    }
+
+    SIMD_SORT_AVX2 static int leftMask(const Vec &v, const Vec &pivot, bool lessEqual)
+    {
+        Vec m = lessEqual ? _mm256_cmp_pd(v, pivot, _CMP_LE_OQ) : _mm256_cmp_pd(v, pivot, _CMP_LT_OQ);
+        return _mm256_movemask_pd(m);
+    }
+
+    SIMD_SORT_AVX2 static Vec compress(const Vec &v, int mask)
+    {
+        static constexpr auto Table = makeCompressTable<4, 2>();
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Table[mask].data()));
+        return _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(v), index));
+    }
+
+    template <int J, int K, int Mask = bitonicMaxMask(4, J, K)>
+    SIMD_SORT_AVX2 static Vec step(const Vec &v)
+    {
+        Vec partner = _mm256_permute4x64_pd(v, (0 ^ J) | ((1 ^ J) << 2) | ((2 ^ J) << 4) | ((3 ^ J) << 6));
+        return _mm256_blend_pd(_mm256_min_pd(v, partner), _mm256_max_pd(v, partner), Mask);
+    }
+
+    SIMD_SORT_AVX2 static Vec merge4(Vec v)
+    {
+        v = step<2, 4>(v);
+        return step<1, 4>(v);
+    }
+
+    SIMD_SORT_AVX2 static Vec sort4(Vec v)
+    {
+        v = step<1, 2>(v);
+        return merge4(v);
+    }
+
+    SIMD_SORT_AVX2 static Vec reverse(const Vec &v)
+    {
+        return _mm256_permute4x64_pd(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+
+    // Sorted a and sorted b into sorted (a, b)
+    SIMD_SORT_AVX2 static void merge(Vec &a, Vec &b)
+    {
+        Vec r = reverse(b);
+        Vec lo = _mm256_min_pd(a, r);
+        Vec hi = _mm256_max_pd(a, r);
+        a = merge4(lo);
+        b = merge4(hi);
+    }
+
+    // Bitonic (a, b) into sorted (a, b)
+    SIMD_SORT_AVX2 static void mergeBitonic8(Vec &a, Vec &b)
+    {
+        Vec lo = _mm256_min_pd(a, b);
+        Vec hi = _mm256_max_pd(a, b);
+        a = merge4(lo);
+        b = merge4(hi);
+    }
+
+    SIMD_SORT_AVX2 static void sortNetwork(double *array, int size)
+    {
+        double buffer[16];
+        for (int i = 0; i < 16; i++)
+        {
+            buffer[i] = i < size ? array[i] : std::numeric_limits<double>::infinity();
+        }
+        Vec a = sort4(load(buffer));
+        Vec b = sort4(load(buffer + 4));
+        Vec c = sort4(load(buffer + 8));
+        Vec d = sort4(load(buffer + 12));
+        merge(a, b);
+        merge(c, d);
+
+        Vec rd = reverse(d);
+        Vec rc = reverse(c);
+        Vec lo0 = _mm256_min_pd(a, rd);
+        Vec lo1 = _mm256_min_pd(b, rc);
+        Vec hi0 = _mm256_max_pd(a, rd);
+        Vec hi1 = _mm256_max_pd(b, rc);
+        mergeBitonic8(lo0, lo1);
+        mergeBitonic8(hi0, hi1);
+
+        store(buffer, lo0);
+        store(buffer + 4, lo1);
+        store(buffer + 8, hi0);
+        store(buffer + 12, hi1);
+        for (int i = 0; i < size; i++)
+        {
+            array[i] = buffer[i];
+        }
+    }
+};
+
+// In-place vector partition of array[left..right-1], which must hold at least
+// two vectors. Returns p with array[left..p-1] < pivot (<= with lessEqual) and
+// the rest on the right. Reading always from the side with less free space
+// keeps a whole vector of already-read slots on both sides for the two stores.
+template <typename Ops>
+SIMD_SORT_AVX2 int avx2Partition(typename Ops::Value *array, int left, int right, typename Ops::Value pivot, bool lessEqual)
+{
+    using T = typename Ops::Value;
+    using Vec = typename Ops::Vec;
+    constexpr int Lanes = Ops::Lanes;
+
+    Vec pivotVec = Ops::set1(pivot);
+    Vec first = Ops::load(array + left);
+    Vec last = Ops::load(array + right - Lanes);
+    int readLeft = left + Lanes;
+    int readRight = right - Lanes;
+    int writeLeft = left;
+    int writeRight = right;
+
+    while (readRight - readLeft >= Lanes)
+    {
+        Vec v;
+        if (readLeft - writeLeft <= writeRight - readRight)
+        {
+            v = Ops::load(array + readLeft);
+            readLeft += Lanes;
+        }
+        else
+        {
+            readRight -= Lanes;
+            v = Ops::load(array + readRight);
+        }
+
+        int mask = Ops::leftMask(v, pivotVec, lessEqual);
+        int count = __builtin_popcount(mask);
+        Vec packed = Ops::compress(v, mask);
+        Ops::store(array + writeLeft, packed);
+        Ops::store(array + writeRight - Lanes, packed);
+        writeLeft += count;
+        writeRight -= Lanes - count;
+    }
+
+    // The two vectors read up front plus a partial tail fill exactly the gap
+    T rest[3 * Lanes];
+    Ops::store(rest, first);
+    Ops::store(rest + Lanes, last);
+    int size = 2 * Lanes;
+    for (int i = readLeft; i < readRight; i++)
+    {
+        rest[size++] = array[i];
+    }
+    for (int i = 0; i < size; i++)
+    {
+        if (lessEqual ? !(pivot < rest[i]) : rest[i] < pivot)
+        {
+            array[writeLeft++] = rest[i];
+        }
+        else
+        {
+            array[--writeRight] = rest[i];
+        }
+    }
+    return writeLeft;
+}
+
+template <typename Ops>
+SIMD_SORT_AVX2 void avx2QuickSortLoop(typename Ops::Value *array, int start, int end, int depthLimit, SortCount &step, SortCount &swapCount)
+{
+    while (end - start + 1 > Ops::NetworkSize)
+    {
+        if (depthLimit == 0)
+        {
+            heapSort(array + start, end - start + 1, step, swapCount);
+            return;
+        }
+        --depthLimit;
+
+        int size = end - start + 1;
+        typename Ops::Value pivot = getPivot(array, start, end);
+        int p = avx2Partition<Ops>(array, start, end + 1, pivot, false);
+        step += size;
+        swapCount += size;
+
+        if (p == start)
+        {
+            // The pivot is the minimum: split off the keys equal to it, they are done
+            p = avx2Partition<Ops>(array, start, end + 1, pivot, true);
+            step += size;
+            swapCount += size;
+            start = p;
+            continue;
+        }
+
+        if (p - start < end - p + 1)
+        {
+            avx2QuickSortLoop<Ops>(array, start, p - 1, depthLimit, step, swapCount);
+            start = p;
+        }
+        else
+        {
+            avx2QuickSortLoop<Ops>(array, p, end, depthLimit, step, swapCount);
+            end = p - 1;
+        }
+    }
+
+    if (start < end)
+    {
+        Ops::sortNetwork(array + start, end - start + 1);
+        step += end - start + 1;
+        swapCount += end - start + 1;
+    }
+}
+
+template <typename Ops>
+SIMD_SORT_AVX2 void avx2QuickSort(typename Ops::Value *array, int start, int end, SortCount &step, SortCount &swapCount)
+{
+    int depthLimit = 0;
+    for (int n = end - start + 1; n > 1; n >>= 1)
+    {
+        depthLimit += 2;
+    }
+    avx2QuickSortLoop<Ops>(array, start, end, depthLimit, step, swapCount);
+}
+
+#endif
+
+inline void simdQuickSort(int *array, int start, int end, SortCount &step, SortCount &swapCount)
+{
+#if SIMD_SORT_HAS_AVX2
+    if (hasAvx2())
+    {
+        avx2QuickSort<Avx2Int>(array, start, end, step, swapCount);
+        return;
+    }
+#endif
+    introSort(array, start, end, step, swapCount);
+}
+
+inline void simdQuickSort(double *array, int start, int end, SortCount &step, SortCount &swapCount)
+{
+#if SIMD_SORT_HAS_AVX2
+    if (hasAvx2())
+    {
+        avx2QuickSort<Avx2Double>(array, start, end, step, swapCount);
+        return;
+    }
+#endif
+    introSort(array, start, end, step, swapCount);
+}
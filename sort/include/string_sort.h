@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "basic_sort.h"
+
+// Ranges at most this long are finished by insertion sort on the suffixes
+constexpr int STRING_INSERT_SORT_THRESHOLD = 16;
+
+// Strings stored back to back in one buffer. Sorting works on string_views
+// into the arena, so moving an element never touches the characters.
+class StringArena
+{
+private:
+    std::vector<char> bytes_;
+    std::vector<std::size_t> offsets_{0};
+
+public:
+    void reserve(const std::size_t &count, const std::size_t &bytes)
+    {
+        offsets_.reserve(count + 1);
+        bytes_.reserve(bytes);
+    }
+
+    void add(const std::string_view &s)
+    {
+        bytes_.insert(bytes_.end(), s.begin(), s.end());
+        offsets_.push_back(bytes_.size());
+    }
+
+    int size() const
+    {
+        return static_cast<int>(offsets_.size()) - 1;
+    }
+
+    std::string_view operator[](const int &i) const
+    {
+        return std::string_view(bytes_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    // Views of every string in insertion order; valid until the next add()
+    std::vector<std::string_view> views() const
+    {
+        std::vector<std::string_view> result;
+        result.reserve(size());
+        for (int i = 0; i < size(); i++)
+        {
+            result.push_back((*this)[i]);
+        }
+        return result;
+    }
+};
+
+// Character of s at depth as 0..255, or -1 past its end, so shorter strings
+// order before their extensions
+inline int charAt(const std::string_view &s, const int &depth)
+{
+    return depth < static_cast<int>(s.size()) ? static_cast<unsigned char>(s[depth]) : -1;
+}
+
+// Insertion sort of strings known to share their first depth characters;
+// only the suffixes are compared
+inline void stringInsertSort(std::string_view *array, const int &size, const int &depth, SortCount &step, SortCount &swapCount)
+{
+    for (int i = 1; i < size; i++)
+    {
+        for (int j = i; j > 0; j--)
+        {
+            ++step;
+            if (array[j].substr(depth) < array[j - 1].substr(depth))
+            {
+                swapElements(array[j - 1], array[j]);
+                ++swapCount;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+}
+
+// Length of the prefix that array[0..size-1] share beyond depth, found with
+// one sequential scan per string
+inline int commonPrefix(const std::string_view *array, const int &size, const int &depth, SortCount &step)
+{
+    std::string_view first = array[0].substr(std::min<std::size_t>(depth, array[0].size()));
+    std::size_t common = first.size();
+    for (int i = 1; i < size && common > 0; i++)
+    {
+        std::string_view s = array[i].substr(std::min<std::size_t>(depth, array[i].size()));
+        std::size_t limit = std::min(common, s.size());
+        std::size_t k = 0;
+        while (k < limit && first[k] == s[k])
+        {
+            ++k;
+        }
+        common = k;
+        ++step;
+    }
+    return static_cast<int>(common);
+}
+
+// Multikey quicksort (Bentley and Sedgewick) of array[0..size-1], given that
+// all of them share their first depth characters. Partitions three ways on the
+// character at depth: the smaller and larger parts keep the depth, the equal
+// part moves on to the next character, so a shared prefix is read once per
+// partitioning step instead of once per comparison. When a whole range lands
+// in the equal part, its common prefix is skipped at once.
+inline void multikeyQuickSort(std::string_view *array, int size, int depth, SortCount &step, SortCount &swapCount)
+{
+    while (size > STRING_INSERT_SORT_THRESHOLD)
+    {
+        // Median of three characters as the pivot
+        int a = charAt(array[0], depth);
+        int b = charAt(array[size / 2], depth);
+        int c = charAt(array[size - 1], depth);
+        int pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (c < b ? b : (a < c ? a : c));
+
+        // array[0..lt) < pivot, array[lt..i) == pivot, array(gt..size) > pivot
+        int lt = 0;
+        int i = 0;
+        int gt = size - 1;
+        while (i <= gt)
+        {
+            int ch = charAt(array[i], depth);
+            ++step;
+            if (ch < pivot)
+            {
+                swapElements(array[lt++], array[i++]);
+                ++swapCount;
+            }
+            else if (ch > pivot)
+            {
+                swapElements(array[i], array[gt--]);
+                ++swapCount;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        multikeyQuickSort(array, lt, depth, step, swapCount);
+        multikeyQuickSort(array + gt + 1, size - gt - 1, depth, step, swapCount);
+
+        // Strings that ended at depth are equal and done
+        if (pivot < 0)
+        {
+            return;
+        }
+        bool allEqual = lt == 0 && gt == size - 1;
+        array += lt;
+        size = gt - lt + 1;
+        ++depth;
+        if (allEqual)
+        {
+            depth += commonPrefix(array, size, depth, step);
+        }
+    }
+
+    stringInsertSort(array, size, depth, step, swapCount);
+}
+
+inline void multikeyQuickSort(std::string_view *array, const int &size, SortCount &step, SortCount &swapCount)
+{
+    multikeyQuickSort(array, size, 0, step, swapCount);
+}
@@ -0,0 +1,374 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "basic_sort.h"
+
+// Consecutive wins by one run before a merge switches to galloping
+constexpr int MIN_GALLOP = 7;
+
+// Natural runs shorter than this are extended by binary insertion (32 to 64)
+inline int computeMinRun(int size)
+{
+    int r = 0;
+    while (size >= 64)
+    {
+        r |= size & 1;
+        size >>= 1;
+    }
+    return size + r;
+}
+
+// Length of the prefix of 0..len-1 for which pred holds, given that pred is
+// true up to some point and false after it. Probes 0, 1, 3, 7, ... and then
+// binary-searches the last gap, so a short prefix costs O(log prefix).
+template <typename Pred>
+int gallop(const int &len, Pred pred)
+{
+    if (len == 0 || !pred(0))
+    {
+        return 0;
+    }
+    int lo = 0;
+    int hi = 1;
+    while (hi < len && pred(hi))
+    {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+    if (hi > len)
+    {
+        hi = len;
+    }
+    while (hi - lo > 1)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (pred(mid))
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return hi;
+}
+
+template <typename T, typename Proj>
+class TimSorter
+{
+private:
+    struct Run
+    {
+        int start;
+        int length;
+        int power; // node power of the boundary to the next run
+    };
+
+    T *array_;
+    int size_;
+    SortCount &step_;
+    SortCount &swapCount_;
+    Proj &proj_;
+    std::vector<T> buffer_;
+
+    bool less(const T &x, const T &y)
+    {
+        ++step_;
+        return lessBy(proj_, x, y);
+    }
+
+    // Returns the end of the run starting at start; descending runs are reversed
+    int findRun(const int &start)
+    {
+        int end = start + 1;
+        if (end == size_)
+        {
+            return end;
+        }
+        if (less(array_[end], array_[end - 1]))
+        {
+            // Only strictly descending runs may be reversed without losing stability
+            while (end + 1 < size_ && less(array_[end + 1], array_[end]))
+            {
+                ++end;
+            }
+            ++end;
+            std::reverse(array_ + start, array_ + end);
+            swapCount_ += (end - start) / 2;
+        }
+        else
+        {
+            while (end + 1 < size_ && !less(array_[end + 1], array_[end]))
+            {
+                ++end;
+            }
+            ++end;
+        }
+        return end;
+    }
+
+    // Sorts array[start..end) by binary insertion, given array[start..sorted) is sorted
+    void binaryInsertionSort(const int &start, int sorted, const int &end)
+    {
+        for (; sorted < end; sorted++)
+        {
+            T key = std::move(array_[sorted]);
+            int lo = start;
+            int hi = sorted;
+            while (lo < hi)
+            {
+                int mid = lo + (hi - lo) / 2;
+                if (less(key, array_[mid]))
+                {
+                    hi = mid;
+                }
+                else
+                {
+                    lo = mid + 1;
+                }
+            }
+            std::move_backward(array_ + lo, array_ + sorted, array_ + sorted + 1);
+            array_[lo] = std::move(key);
+            swapCount_ += sorted - lo + 1;
+        }
+    }
+
+    // Powersort priority of the boundary between two adjacent runs: the depth of
+    // the split between their midpoints in the implicit bisection of [0, size)
+    int nodePower(const Run &a, const Run &b) const
+    {
+        unsigned long long twoN = 2ULL * size_;
+        unsigned long long x = 2ULL * a.start + a.length;
+        unsigned long long y = 2ULL * b.start + b.length;
+        int power = 0;
+        while (x / twoN == y / twoN)
+        {
+            ++power;
+            x <<= 1;
+            y <<= 1;
+        }
+        return power;
+    }
+
+    // Left run is no longer than the right one: buffer it and merge forwards
+    void mergeLo(int dest, const int &leftLength, int right, const int &end)
+    {
+        buffer_.clear();
+        for (int k = 0; k < leftLength; k++)
+        {
+            buffer_.push_back(std::move(array_[dest + k]));
+        }
+        swapCount_ += leftLength;
+
+        int i = 0;
+        int winsLeft = 0;
+        int winsRight = 0;
+        while (i < leftLength && right < end)
+        {
+            if (less(array_[right], buffer_[i]))
+            {
+                array_[dest++] = std::move(array_[right++]);
+                ++winsRight;
+                winsLeft = 0;
+            }
+            else
+            {
+                array_[dest++] = std::move(buffer_[i++]);
+                ++winsLeft;
+                winsRight = 0;
+            }
+            ++swapCount_;
+
+            // Either run may have just run out, and then there is nothing to gallop over
+            if ((winsLeft >= MIN_GALLOP || winsRight >= MIN_GALLOP) && i < leftLength && right < end)
+            {
+                int countLeft, countRight;
+                do
+                {
+                    // Buffered elements not greater than the next right element
+                    const T &r = array_[right];
+                    countLeft = gallop(leftLength - i, [&](const int &t) { return !less(r, buffer_[i + t]); });
+                    dest = static_cast<int>(std::move(buffer_.begin() + i, buffer_.begin() + i + countLeft, array_ + dest) - array_);
+                    i += countLeft;
+                    swapCount_ += countLeft;
+                    if (i == leftLength)
+                    {
+                        break;
+                    }
+
+                    // Right elements smaller than the next buffered element
+                    const T &l = buffer_[i];
+                    countRight = gallop(end - right, [&](const int &t) { return less(array_[right + t], l); });
+                    dest = static_cast<int>(std::move(array_ + right, array_ + right + countRight, array_ + dest) - array_);
+                    right += countRight;
+                    swapCount_ += countRight;
+                    if (right == end)
+                    {
+                        break;
+                    }
+                } while (countLeft >= MIN_GALLOP || countRight >= MIN_GALLOP);
+                winsLeft = winsRight = 0;
+            }
+        }
+
+        // What is left of the right run is already in place
+        std::move(buffer_.begin() + i, buffer_.begin() + leftLength, array_ + dest);
+        swapCount_ += leftLength - i;
+    }
+
+    // Right run is shorter: buffer it and merge backwards from the end
+    void mergeHi(const int &start, int left, const int &mid, const int &rightLength)
+    {
+        buffer_.clear();
+        for (int k = 0; k < rightLength; k++)
+        {
+            buffer_.push_back(std::move(array_[mid + k]));
+        }
+        swapCount_ += rightLength;
+
+        int dest = mid + rightLength; // one past the next slot to fill
+        int j = rightLength;          // buffer_[0..j) still to place
+        int winsLeft = 0;
+        int winsRight = 0;
+        while (j > 0 && left > start)
+        {
+            if (less(buffer_[j - 1], array_[left - 1]))
+            {
+                array_[--dest] = std::move(array_[--left]);
+                ++winsLeft;
+                winsRight = 0;
+            }
+            else
+            {
+                array_[--dest] = std::move(buffer_[--j]);
+                ++winsRight;
+                winsLeft = 0;
+            }
+            ++swapCount_;
+
+            if ((winsLeft >= MIN_GALLOP || winsRight >= MIN_GALLOP) && j > 0 && left > start)
+            {
+                int countLeft, countRight;
+                do
+                {
+                    // Left elements greater than the last buffered element
+                    const T &r = buffer_[j - 1];
+                    countLeft = gallop(left - start, [&](const int &t) { return less(r, array_[left - 1 - t]); });
+                    dest = static_cast<int>(std::move_backward(array_ + left - countLeft, array_ + left, array_ + dest) - array_);
+                    left -= countLeft;
+                    swapCount_ += countLeft;
+                    if (left == start)
+                    {
+                        break;
+                    }
+
+                    // Buffered elements not smaller than the last left element
+                    const T &l = array_[left - 1];
+                    countRight = gallop(j, [&](const int &t) { return !less(buffer_[j - 1 - t], l); });
+                    dest = static_cast<int>(std::move_backward(buffer_.begin() + j - countRight, buffer_.begin() + j, array_ + dest) - array_);
+                    j -= countRight;
+                    swapCount_ += countRight;
+                    if (j == 0)
+                    {
+                        break;
+                    }
+                } while (countLeft >= MIN_GALLOP || countRight >= MIN_GALLOP);
+                winsLeft = winsRight = 0;
+            }
+        }
+
+        // What is left of the left run is already in place
+        std::move_backward(buffer_.begin(), buffer_.begin() + j, array_ + dest);
+        swapCount_ += j;
+    }
+
+    // Merges two adjacent runs, first trimming the parts that are already in place
+    Run merge(const Run &a, const Run &b)
+    {
+        int start = a.start;
+        int mid = b.start;
+        int end = b.start + b.length;
+
+        // Elements of a not greater than b's first one stay put
+        const T &first = array_[mid];
+        start += gallop(mid - start, [&](const int &t) { return !less(first, array_[start + t]); });
+        if (start == mid)
+        {
+            return {a.start, a.length + b.length, 0};
+        }
+        // Elements of b not smaller than a's last one stay put
+        const T &last = array_[mid - 1];
+        end -= gallop(end - mid, [&](const int &t) { return !less(array_[end - 1 - t], last); });
+
+        if (mid - start <= end - mid)
+        {
+            mergeLo(start, mid - start, mid, end);
+        }
+        else
+        {
+            mergeHi(start, mid, mid, end - mid);
+        }
+        return {a.start, a.length + b.length, 0};
+    }
+
+public:
+    TimSorter(T *array, int size, SortCount &step, SortCount &swapCount, Proj &proj)
+        : array_(array), size_(size), step_(step), swapCount_(swapCount), proj_(proj)
+    {
+        buffer_.reserve(size / 2);
+    }
+
+    void sort()
+    {
+        if (size_ < 2)
+        {
+            return;
+        }
+        int minRun = computeMinRun(size_);
+
+        auto nextRun = [&](const int &start) {
+            int end = findRun(start);
+            int extended = std::min(start + minRun, size_);
+            if (end < extended)
+            {
+                binaryInsertionSort(start, end, extended);
+                end = extended;
+            }
+            return Run{start, end - start, 0};
+        };
+
+        std::vector<Run> stack;
+        Run a = nextRun(0);
+        while (a.start + a.length < size_)
+        {
+            Run b = nextRun(a.start + a.length);
+            int power = nodePower(a, b);
+            while (!stack.empty() && stack.back().power > power)
+            {
+                a = merge(stack.back(), a);
+                stack.pop_back();
+            }
+            a.power = power;
+            stack.push_back(a);
+            a = b;
+        }
+        while (!stack.empty())
+        {
+            a = merge(stack.back(), a);
+            stack.pop_back();
+        }
+    }
+};
+
+// Stable adaptive merge sort in the style of Timsort. Natural ascending and
+// strictly descending runs are detected, short runs are extended by binary
+// insertion, and runs are merged in the order given by powersort's node powers
+// with galloping merges. Presorted input costs O(n).
+template <typename T, typename Proj = Identity>
+void timSort(T *array, int size, SortCount &step, SortCount &swapCount, Proj proj = Proj())
+{
+    TimSorter<T, Proj>(array, size, step, swapCount, proj).sort();
+}
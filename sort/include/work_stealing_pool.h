@@ -0,0 +1,196 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Fork-join task pool.
+// Every worker owns a deque: it pushes and pops its own tasks at the back
+// and, when that runs dry, steals the oldest task from another worker's front.
+// The pool-wide mutex_ is only taken to sleep and to wake sleepers; spawning
+// and taking tasks touch the per-worker deques and atomic counters.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(int threadCount) : queues_(threadCount < 1 ? 1 : threadCount)
+    {
+        for (int i = 0; i < size(); i++)
+        {
+            threads_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeCv_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    int size() const
+    {
+        return static_cast<int>(queues_.size());
+    }
+
+    // Index of the calling worker, or -1 when called from outside the pool
+    int workerIndex() const
+    {
+        return currentPool_ == this ? currentIndex_ : -1;
+    }
+
+    // Queues a task on the calling worker (worker 0 for outside callers)
+    void spawn(Task task)
+    {
+        pending_.fetch_add(1);
+        int index = workerIndex();
+        queues_[index < 0 ? 0 : index].pushBack(std::move(task));
+        queued_.fetch_add(1);
+        // A worker counts itself in sleeping_ under mutex_ before it checks
+        // queued_, so either it sees this task or it is seen here and woken;
+        // taking the lock makes sure it is already waiting
+        if (sleeping_.load() > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            wakeCv_.notify_one();
+        }
+    }
+
+    // Runs a task and blocks until it and every task it spawned have finished.
+    // Completion is tracked for the whole pool, so only one thread outside the
+    // pool may be in run at a time; from a worker it would wait for itself.
+    void run(Task task)
+    {
+        if (workerIndex() >= 0)
+        {
+            throw std::logic_error("work stealing pool: run called from a worker");
+        }
+        if (running_.exchange(true))
+        {
+            throw std::logic_error("work stealing pool: run called concurrently");
+        }
+        spawn(std::move(task));
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            doneCv_.wait(lock, [this] { return pending_.load() == 0; });
+        }
+        running_.store(false);
+    }
+
+private:
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+
+        void pushBack(Task task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+
+        bool popBack(Task &task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+            {
+                return false;
+            }
+            task = std::move(tasks.back());
+            tasks.pop_back();
+            return true;
+        }
+
+        bool popFront(Task &task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+            {
+                return false;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            return true;
+        }
+    };
+
+    bool trySteal(int self, Task &task, std::mt19937 &engine)
+    {
+        int count = size();
+        int first = std::uniform_int_distribution<int>(0, count - 1)(engine);
+        for (int k = 0; k < count; k++)
+        {
+            int victim = (first + k) % count;
+            if (victim != self && queues_[victim].popFront(task))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(int index)
+    {
+        currentPool_ = this;
+        currentIndex_ = index;
+        std::mt19937 engine(index);
+
+        while (true)
+        {
+            Task task;
+            if (queues_[index].popBack(task) || trySteal(index, task, engine))
+            {
+                queued_.fetch_sub(1);
+                task();
+                if (pending_.fetch_sub(1) == 1)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    doneCv_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopping_)
+            {
+                return;
+            }
+            // queued_ also counts a task pushed after the scan above, so the
+            // wait returns at once instead of missing it
+            sleeping_.fetch_add(1);
+            wakeCv_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+            sleeping_.fetch_sub(1);
+        }
+    }
+
+    inline static thread_local const WorkStealingPool *currentPool_ = nullptr;
+    inline static thread_local int currentIndex_ = -1;
+
+    std::vector<Queue> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wakeCv_;
+    std::condition_variable doneCv_;
+    std::atomic<int> pending_{0};  // spawned tasks not yet finished
+    std::atomic<int> queued_{0};   // tasks sitting in a deque
+    std::atomic<int> sleeping_{0}; // workers waiting on wakeCv_
+    std::atomic<bool> running_{false};
+    bool stopping_ = false;
+};
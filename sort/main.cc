@@ -2,185 +2,817 @@
 #include <random>
 #include <string>
 #include <array>
-
-template <typename T>
-void swap(T &x, T &y)
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+#include "arg_sort.h"
+#include "array_utility.h"
+#include "basic_sort.h"
+#include "block_partition.h"
+#include "external_sort.h"
+#include "int_io.h"
+#include "intro_sort.h"
+#include "kway_merge.h"
+#include "parallel_merge_sort.h"
+#include "parallel_quick_sort.h"
+#include "parallel_sample_sort.h"
+#include "perf_counters.h"
+#include "radix_sort.h"
+#include "selection.h"
+#include "simd_sort.h"
+#include "string_sort.h"
+#include "tim_sort.h"
+
+// Wall time of parallelQuickSort on one random array for 1 to N threads
+void printScalingReport(const int &size)
 {
-    T tmp = x;
-    x = y;
-    y = tmp;
-}
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if (maxThreads < 1)
+    {
+        maxThreads = 1;
+    }
 
-template <typename T>
-T median(const T &x, const T &y, const T &z)
-{
-    if (x < y)
+    int *problem = new int[size];
+    int *array = new int[size];
+    makeArrayRandom(problem, size);
+
+    std::cout << "Parallel quick sort scaling" << std::endl;
+    std::cout << "Problem Size = " << size << ", Cutoff = " << PARALLEL_SORT_CUTOFF << std::endl;
+
+    double baseTime = 0;
+    for (int threads = 0; threads <= maxThreads; threads++)
     {
-        if (y < z)
+        std::copy(problem, problem + size, array);
+        SortCount step = 0;
+        SortCount swapCount = 0;
+
+        auto begin = std::chrono::steady_clock::now();
+        if (threads == 0)
+        {
+            quickSort(array, 0, size - 1, step, swapCount);
+        }
+        else
         {
-            return y;
+            parallelQuickSort(array, 0, size - 1, step, swapCount, threads);
         }
-        else if (z < x)
+        auto finish = std::chrono::steady_clock::now();
+        double time = std::chrono::duration<double, std::milli>(finish - begin).count();
+
+        if (threads == 0)
         {
-            return x;
+            baseTime = time;
+            std::cout << "Serial";
         }
         else
         {
-            return z;
+            std::cout << "Threads = " << threads;
         }
+        std::cout << "-> time = " << time << " ms, speedup = " << baseTime / time
+                  << ", step = " << step << ", swap = " << swapCount
+                  << (isSorted(array, size) ? "" : " (NOT SORTED)") << "\n";
     }
-    else
+
+    delete[] problem;
+    delete[] array;
+}
+
+// Median wall time of quickSort, blockQuickSort and simdQuickSort over a few trials
+// on random and low-entropy arrays
+void printPartitionBenchmark(const int &size)
+{
+    constexpr int Trials = 5;
+    std::array<std::string, 3> sortNames = {"Hoare", "Block", hasAvx2() ? "Avx2" : "Scalar"};
+    int *problem = new int[size];
+    int *array = new int[size];
+
+    std::cout << "Partition benchmark" << std::endl;
+    std::cout << "Problem Size = " << size << ", Trials = " << Trials << std::endl;
+
+    for (int input = 0; input < 2; input++)
     {
-        if (z < y)
+        makeArrayRandom(problem, size);
+        if (input == 1)
+        {
+            // Only 16 distinct keys
+            for (int i = 0; i < size; i++)
+            {
+                problem[i] %= 16;
+            }
+        }
+
+        for (int algorithm = 0; algorithm < 3; algorithm++)
         {
-            return y;
+            std::array<double, Trials> times;
+            SortCount step = 0;
+            SortCount swapCount = 0;
+            bool sorted = true;
+            for (int trial = 0; trial < Trials; trial++)
+            {
+                std::copy(problem, problem + size, array);
+                step = 0;
+                swapCount = 0;
+
+                auto begin = std::chrono::steady_clock::now();
+                if (algorithm == 0)
+                {
+                    quickSort(array, 0, size - 1, step, swapCount);
+                }
+                else if (algorithm == 1)
+                {
+                    blockQuickSort(array, 0, size - 1, step, swapCount);
+                }
+                else
+                {
+                    simdQuickSort(array, 0, size - 1, step, swapCount);
+                }
+                auto finish = std::chrono::steady_clock::now();
+                times[trial] = std::chrono::duration<double, std::milli>(finish - begin).count();
+                sorted = sorted && isSorted(array, size);
+            }
+            std::sort(times.begin(), times.end());
+
+            std::cout << (input == 0 ? "Random" : "LowEntropy") << " "
+                      << sortNames[algorithm] << "-> time = " << times[Trials / 2]
+                      << " ms, step = " << step << ", swap = " << swapCount
+                      << (sorted ? "" : " (NOT SORTED)") << "\n";
         }
-        else if (x < z)
+    }
+
+    delete[] problem;
+    delete[] array;
+}
+
+// parallelSampleSort and parallelMergeSort against introSort on the
+// makeArrayRandom and makeArrayInverse inputs, plus a stability check of
+// parallelMergeSort on (key, position) pairs
+void printParallelSortReport(const int &size)
+{
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    WorkStealingPool pool(threads);
+    std::vector<int> problem(size);
+    std::vector<int> expected(size);
+    std::vector<int> array(size);
+
+    std::cout << "Parallel sample / merge sort" << std::endl;
+    std::cout << "Problem Size = " << size << ", Threads = " << threads << std::endl;
+
+    for (int input = 0; input < 2; input++)
+    {
+        if (input == 0)
         {
-            return x;
+            makeArrayRandom(problem.data(), size);
         }
         else
         {
-            return z;
+            makeArrayInverse(problem.data(), size);
+        }
+        expected = problem;
+        SortCount introStep = 0;
+        SortCount introSwap = 0;
+        introSort(expected.data(), 0, size - 1, introStep, introSwap);
+
+        for (int algorithm = 0; algorithm < 2; algorithm++)
+        {
+            array = problem;
+            SortCount step = 0;
+            SortCount swapCount = 0;
+            auto begin = std::chrono::steady_clock::now();
+            if (algorithm == 0)
+            {
+                parallelSampleSort(pool, array.data(), size, step, swapCount);
+            }
+            else
+            {
+                parallelMergeSort(pool, array.data(), size, step, swapCount);
+            }
+            auto finish = std::chrono::steady_clock::now();
+
+            std::cout << (input == 0 ? "Random " : "Inverse ") << (algorithm == 0 ? "Sample" : "Merge")
+                      << "-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+                      << " ms, step = " << step << ", swap = " << swapCount
+                      << (array == expected ? "" : " (WRONG)") << "\n";
         }
     }
-}
 
-template <typename T>
-T getPivot(const T *array, const int &start, const int &end)
-{
-    return median(array[start], array[start + (end - start) / 2], array[end]);
+    std::vector<std::pair<int, int>> records(size);
+    for (int i = 0; i < size; i++)
+    {
+        records[i] = std::make_pair(problem[i] % 100, i);
+    }
+    SortCount step = 0;
+    SortCount swapCount = 0;
+    parallelMergeSort(pool, records.data(), size, step, swapCount, [](const std::pair<int, int> &x) { return x.first; });
+    std::cout << "Stable Merge-> " << (std::is_sorted(records.begin(), records.end()) ? "ok" : "NOT STABLE") << "\n";
 }
 
-template <typename T>
-void bubbleSort(T *array, int size, int &step, int &swapCount)
+// nthElement, partialSort and streaming TopK against a full introSort, on
+// makeArrayRandom input, with a check of every result against the sorted array
+void printSelectionReport(const int &size, const int &k)
 {
-    for (int i = 0; i < size - 1; i++)
+    std::vector<int> problem(size);
+    makeArrayRandom(problem.data(), size);
+    std::vector<int> expected = problem;
+    SortCount introStep = 0;
+    SortCount introSwap = 0;
+    auto begin = std::chrono::steady_clock::now();
+    introSort(expected.data(), 0, size - 1, introStep, introSwap);
+    auto finish = std::chrono::steady_clock::now();
+
+    std::cout << "Selection" << std::endl;
+    std::cout << "Problem Size = " << size << ", k = " << k << std::endl;
+    std::cout << "Intro Sort-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+              << " ms, step = " << introStep << ", swap = " << introSwap << "\n";
+
+    for (int algorithm = 0; algorithm < 3; algorithm++)
     {
-        for (int j = 1; j < size - i; j++)
+        std::vector<int> array = problem;
+        SortCount step = 0;
+        SortCount swapCount = 0;
+        bool ok = true;
+        begin = std::chrono::steady_clock::now();
+        if (algorithm == 0)
         {
-            step++;
-            if (array[j] < array[j - 1])
+            nthElement(array.data(), 0, size - 1, k - 1, step, swapCount);
+            finish = std::chrono::steady_clock::now();
+            ok = array[k - 1] == expected[k - 1];
+            for (int i = 0; ok && i < size; i++)
             {
-                swap(array[j], array[j - 1]);
-                ++swapCount;
+                ok = i < k ? array[i] <= array[k - 1] : array[k - 1] <= array[i];
             }
         }
+        else if (algorithm == 1)
+        {
+            partialSort(array.data(), size, k, step, swapCount);
+            finish = std::chrono::steady_clock::now();
+            ok = std::equal(array.begin(), array.begin() + k, expected.begin());
+        }
+        else
+        {
+            TopK<int> topK(k);
+            for (const int &x : problem)
+            {
+                topK.push(x);
+            }
+            std::vector<int> smallest = topK.sorted();
+            finish = std::chrono::steady_clock::now();
+            step = topK.step();
+            swapCount = topK.swapCount();
+            ok = std::equal(smallest.begin(), smallest.end(), expected.begin());
+        }
+
+        std::cout << (algorithm == 0 ? "Nth Element" : algorithm == 1 ? "Partial Sort" : "Top K")
+                  << "-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+                  << " ms, step = " << step << ", swap = " << swapCount << (ok ? "" : " (WRONG)") << "\n";
     }
 }
 
-template <typename T>
-void quickSort(T *array, int start, int end, int &step, int &swapCount)
+// Merging k sorted shards of makeArrayRandom data: loser tree kWayMerge,
+// rounds of pairwise 2-way merges, and concatenating and re-sorting with
+// quickSort; then the loser tree once more over the shards as binary files
+void printMergeReport(const int &size, const int &k)
 {
-    if (start < end)
+    std::vector<int> problem(size);
+    makeArrayRandom(problem.data(), size);
+    std::vector<int> bounds;
+    for (int s = 0; s <= k; s++)
+    {
+        bounds.push_back(static_cast<int>(static_cast<long long>(size) * s / k));
+    }
+    SortCount shardStep = 0;
+    SortCount shardSwap = 0;
+    for (int s = 0; s < k; s++)
     {
-        int i = start;
-        int j = end;
-        T pivot = getPivot(array, start, end);
+        introSort(problem.data(), bounds[s], bounds[s + 1] - 1, shardStep, shardSwap);
+    }
+    std::vector<int> expected = problem;
+    std::sort(expected.begin(), expected.end());
 
-        while (true)
-        {
+    std::cout << "K-way merge" << std::endl;
+    std::cout << "Problem Size = " << size << ", Shards = " << k << std::endl;
 
-            while (array[i] < pivot)
+    for (int algorithm = 0; algorithm < 4; algorithm++)
+    {
+        std::vector<int> array(size);
+        SortCount step = 0;
+        SortCount swapCount = 0;
+        auto begin = std::chrono::steady_clock::now();
+        if (algorithm == 0)
+        {
+            std::vector<const int *> shards;
+            std::vector<int> sizes;
+            for (int s = 0; s < k; s++)
             {
-                ++step;
-                ++i;
+                shards.push_back(problem.data() + bounds[s]);
+                sizes.push_back(bounds[s + 1] - bounds[s]);
             }
-            ++step;
-
-            while (pivot < array[j])
+            kWayMerge(shards, sizes, array.data(), step, swapCount);
+        }
+        else if (algorithm == 1)
+        {
+            // Neighbouring runs are merged pairwise until one is left
+            array = problem;
+            std::vector<int> buffer(size);
+            std::vector<int> runs = bounds;
+            Identity proj;
+            while (runs.size() > 2)
             {
-                ++step;
-                --j;
+                std::vector<int> next;
+                for (std::size_t r = 0; r + 1 < runs.size(); r += 2)
+                {
+                    int mid = runs[r + 1];
+                    int end = r + 2 < runs.size() ? runs[r + 2] : mid;
+                    moveMerge(array.data() + runs[r], array.data() + mid, array.data() + mid, array.data() + end,
+                              buffer.data() + runs[r], step, swapCount, proj);
+                    next.push_back(runs[r]);
+                }
+                next.push_back(size);
+                runs.swap(next);
+                array.swap(buffer);
             }
-            ++step;
-
-            if (i >= j)
+        }
+        else if (algorithm == 2)
+        {
+            array = problem;
+            quickSort(array.data(), 0, size - 1, step, swapCount);
+        }
+        else
+        {
+            // Scratch files in the temporary directory, removed however the merge ends
+            struct ScratchFiles
+            {
+                std::vector<std::string> paths;
+
+                ~ScratchFiles()
+                {
+                    for (const std::string &path : paths)
+                    {
+                        std::remove(path.c_str());
+                    }
+                }
+            } scratch;
+            std::string prefix = (std::filesystem::temp_directory_path() /
+                                  ("sort_merge_" + std::to_string(std::random_device()()) + "_")).string();
+            std::vector<std::string> paths;
+            for (int s = 0; s < k; s++)
             {
-                break;
+                paths.push_back(prefix + std::to_string(s) + ".bin");
+                scratch.paths.push_back(paths.back());
+                RunFile file = openRunFile(paths.back(), "wb");
+                writeBinary(file.get(), problem.data() + bounds[s], bounds[s + 1] - bounds[s]);
             }
-
-            swap(array[i], array[j]);
-            ++swapCount;
-
-            ++i;
-            --j;
+            std::string output = prefix + "output.bin";
+            scratch.paths.push_back(output);
+            begin = std::chrono::steady_clock::now();
+            kWayMergeFiles<int>(paths, output, 1 << 16, step, swapCount);
+            auto finish = std::chrono::steady_clock::now();
+            array = readBinary<int>(output);
+            std::cout << "Loser Tree Files-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+                      << " ms, step = " << step << ", swap = " << swapCount << (array == expected ? "" : " (WRONG)") << "\n";
+            continue;
         }
+        auto finish = std::chrono::steady_clock::now();
 
-        quickSort(array, start, i - 1, step, swapCount);
-        quickSort(array, j + 1, end, step, swapCount);
+        std::cout << (algorithm == 0 ? "Loser Tree" : algorithm == 1 ? "Pairwise" : "Quick Sort")
+                  << "-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+                  << " ms, step = " << step << ", swap = " << swapCount << (array == expected ? "" : " (WRONG)") << "\n";
     }
 }
 
-template <typename T>
-void insertSort(T *array, const int &size, int &step, int &swapCount)
+// multikeyQuickSort on views into a StringArena against the generic quickSort
+// on std::string and introSort on the same views, for random strings and for
+// URL-like strings that share long prefixes
+void printStringSortReport(const int &size)
 {
-    for (int i = 1; i < size; i++)
+    std::mt19937 engine(size);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> category(0, 7);
+    std::uniform_int_distribution<int> item(0, 999999);
+
+    std::cout << "String sorts" << std::endl;
+    std::cout << "Problem Size = " << size << std::endl;
+
+    for (int input = 0; input < 2; input++)
     {
-        for (int j = i; j > 0; j--)
+        std::vector<std::string> strings(size);
+        for (std::string &x : strings)
+        {
+            if (input == 0)
+            {
+                for (int i = 0; i < 32; i++)
+                {
+                    x.push_back(static_cast<char>(letter(engine)));
+                }
+            }
+            else
+            {
+                x = "https://www.example.com/catalog/products/category-" + std::to_string(category(engine)) +
+                    "/item-" + std::to_string(item(engine));
+            }
+        }
+        std::vector<std::string> expected(strings);
+        std::sort(expected.begin(), expected.end());
+
+        StringArena arena;
+        for (const std::string &x : strings)
         {
-            ++step;
-            if (array[j - 1] > array[j])
+            arena.add(x);
+        }
+
+        for (int algorithm = 0; algorithm < 3; algorithm++)
+        {
+            SortCount step = 0;
+            SortCount swapCount = 0;
+            bool ok = true;
+            std::vector<std::string> work;
+            std::vector<std::string_view> views;
+            if (algorithm == 0)
+            {
+                work = strings;
+            }
+            else
+            {
+                views = arena.views();
+            }
+
+            auto begin = std::chrono::steady_clock::now();
+            if (algorithm == 0)
+            {
+                quickSort(work.data(), 0, size - 1, step, swapCount);
+            }
+            else if (algorithm == 1)
             {
-                swap(array[j - 1], array[j]);
-                ++swapCount;
+                introSort(views.data(), 0, size - 1, step, swapCount);
             }
             else
             {
-                break;
+                multikeyQuickSort(views.data(), size, step, swapCount);
             }
+            auto finish = std::chrono::steady_clock::now();
+
+            if (algorithm == 0)
+            {
+                ok = work == expected;
+            }
+            else
+            {
+                ok = std::equal(views.begin(), views.end(), expected.begin());
+            }
+            std::cout << (input == 0 ? "Random " : "Prefixed ")
+                      << (algorithm == 0 ? "String Quick" : algorithm == 1 ? "View Intro" : "Multikey Quick")
+                      << "-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+                      << " ms, step = " << step << ", swap = " << swapCount << (ok ? "" : " (WRONG)") << "\n";
         }
     }
 }
 
-void printArray(int *array, const int &size)
+// Heap allocations of the heavy strings, to show that sorting them moves
+// instead of copying. They are counted by the strings' allocator, so the rest
+// of the program keeps the default operator new.
+long long allocationCount = 0;
+
+template <typename T>
+struct CountingAllocator
 {
-    for (int i = 0; i < size; i++)
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &)
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        ++allocationCount;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n)
     {
-        std::cout << array[i] << " ";
+        std::allocator<T>().deallocate(p, n);
     }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return true;
 }
 
-void makeArrayRandom(int *array, const int &size)
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T> &, const CountingAllocator<U> &)
 {
-    std::random_device seed_gen;
-    std::mt19937 engine(seed_gen());
-    std::uniform_int_distribution<int> dist(1, 100000);
+    return false;
+}
 
-    for (int i = 0; i < size; i++)
+using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+struct Record
+{
+    int key;
+    char payload[124];
+};
+
+// Time and string allocations of the generic sorts on 32-character strings and on
+// 128-byte records keyed by Record::key, directly and through argSort
+void printHeavySortReport(const int &size)
+{
+    std::mt19937 engine(size);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> key(1, 100000);
+
+    std::vector<CountedString> strings(size);
+    for (CountedString &x : strings)
     {
-        array[i] = dist(engine);
+        for (int i = 0; i < 32; i++)
+        {
+            x.push_back(static_cast<char>(letter(engine)));
+        }
+    }
+    std::vector<Record> records(size);
+    for (Record &x : records)
+    {
+        x.key = key(engine);
+        std::fill(std::begin(x.payload), std::end(x.payload), static_cast<char>(x.key));
     }
+
+    std::cout << "Heavy element sorts" << std::endl;
+    std::cout << "Problem Size = " << size << std::endl;
+
+    auto report = [](const std::string &name, auto &&sort) {
+        SortCount step = 0;
+        SortCount swapCount = 0;
+        long long allocations = allocationCount;
+        auto begin = std::chrono::steady_clock::now();
+        bool sorted = sort(step, swapCount);
+        auto finish = std::chrono::steady_clock::now();
+        std::cout << name << "-> time = " << std::chrono::duration<double, std::milli>(finish - begin).count()
+                  << " ms, allocations = " << allocationCount - allocations << ", step = " << step
+                  << ", swap = " << swapCount << (sorted ? "" : " (NOT SORTED)") << "\n";
+    };
+
+    auto byKey = [](const Record &x, const Record &y) { return x.key < y.key; };
+
+    std::vector<CountedString> work(strings);
+    report("String Quick", [&](SortCount &step, SortCount &swapCount) {
+        quickSort(work.data(), 0, size - 1, step, swapCount);
+        return std::is_sorted(work.begin(), work.end());
+    });
+    work = strings;
+    report("String Intro", [&](SortCount &step, SortCount &swapCount) {
+        introSort(work.data(), 0, size - 1, step, swapCount);
+        return std::is_sorted(work.begin(), work.end());
+    });
+    work = strings;
+    report("String ArgSort", [&](SortCount &step, SortCount &swapCount) {
+        std::vector<int> order = argSort(work.data(), size, step, swapCount);
+        applyOrder(work.data(), order);
+        return std::is_sorted(work.begin(), work.end());
+    });
+
+    std::vector<Record> workRecords(records);
+    report("Record Quick", [&](SortCount &step, SortCount &swapCount) {
+        quickSort(workRecords.data(), 0, size - 1, step, swapCount, &Record::key);
+        return std::is_sorted(workRecords.begin(), workRecords.end(), byKey);
+    });
+    workRecords = records;
+    report("Record Intro", [&](SortCount &step, SortCount &swapCount) {
+        introSort(workRecords.data(), 0, size - 1, step, swapCount, &Record::key);
+        return std::is_sorted(workRecords.begin(), workRecords.end(), byKey);
+    });
+    workRecords = records;
+    report("Record ArgSort", [&](SortCount &step, SortCount &swapCount) {
+        std::vector<int> order = argSort(workRecords.data(), size, step, swapCount, &Record::key);
+        applyOrder(workRecords.data(), order);
+        return std::is_sorted(workRecords.begin(), workRecords.end(), byKey);
+    });
 }
 
-void makeArrayInverse(int *array, const int &size)
+// Sorts a whole file of ints with radixSort. Formats are "text" (any
+// separators on input, one value per line on output) or "binary" (raw
+// little-endian); "-" names stdin or stdout. Timings go to stderr.
+void sortFile(const std::string &input, const std::string &output, const std::string &inputFormat, const std::string &outputFormat)
 {
-    for (int i = 0; i < size; i++)
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<int> array = inputFormat == "binary" ? readBinary<int>(input) : readText<int>(input);
+    auto read = std::chrono::steady_clock::now();
+
+    SortCount step = 0;
+    SortCount swapCount = 0;
+    radixSort(array.data(), static_cast<int>(array.size()), step, swapCount);
+    auto sorted = std::chrono::steady_clock::now();
+
+    std::FILE *file = output == "-" ? stdout : std::fopen(output.c_str(), "wb");
+    if (file == nullptr)
+    {
+        throw std::runtime_error("int io: cannot open " + output);
+    }
+    if (outputFormat == "binary")
+    {
+        writeBinary(file, array.data(), static_cast<int>(array.size()));
+    }
+    else
     {
-        array[i] = size - i;
+        writeText(file, array.data(), static_cast<int>(array.size()));
     }
+    if (file != stdout && std::fclose(file) != 0)
+    {
+        throw std::runtime_error("int io: failed to write " + output);
+    }
+    auto written = std::chrono::steady_clock::now();
+
+    std::cerr << "File-> size = " << array.size()
+              << ", read = " << std::chrono::duration<double, std::milli>(read - begin).count() << " ms"
+              << ", sort = " << std::chrono::duration<double, std::milli>(sorted - read).count() << " ms"
+              << ", write = " << std::chrono::duration<double, std::milli>(written - sorted).count() << " ms\n";
 }
 
-void makeArrayInput(int *array, const int &size)
+// networkSort on std::array<int, N>: every 0-1 input up to 16 elements (by the
+// 0-1 principle a network that sorts those sorts everything), random
+// permutations above that
+template <int N>
+bool checkArrayNetwork(std::mt19937 &engine)
 {
-    for (int i = 0; i < size; i++)
+    std::array<int, N> array;
+    auto sortsCorrectly = [&]() {
+        std::array<int, N> expected = array;
+        std::sort(expected.begin(), expected.end());
+        networkSort(array);
+        return array == expected;
+    };
+    if (N <= 16)
+    {
+        for (unsigned long long bits = 0; bits < (1ULL << N); bits++)
+        {
+            for (int i = 0; i < N; i++)
+            {
+                array[i] = (bits >> i) & 1;
+            }
+            if (!sortsCorrectly())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    for (int trial = 0; trial < 10000; trial++)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            array[i] = i;
+        }
+        std::shuffle(array.begin(), array.end(), engine);
+        if (!sortsCorrectly())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <std::size_t... N>
+bool checkArrayNetworks(std::index_sequence<N...>)
+{
+    std::mt19937 engine(1);
+    return (checkArrayNetwork<static_cast<int>(N)>(engine) && ...);
+}
+
+// Inputs that once broke a sort, each checked against std::sort in a vector of
+// exactly its size so that out-of-bounds reads show up under AddressSanitizer
+bool runRegressionChecks()
+{
+    bool ok = true;
+    auto check = [&](const std::string &name, bool passed) {
+        std::cout << name << ": " << (passed ? "ok" : "FAILED") << "\n";
+        ok = ok && passed;
+    };
+
+    // mergeLo ran out of right elements on its 7th straight win and galloped past the end
+    std::vector<int> gallopEnd;
+    for (int x = 0; x <= 122; x += 2)
+    {
+        gallopEnd.push_back(x);
+    }
+    gallopEnd.push_back(499);
+    gallopEnd.push_back(1000);
+    for (int x = 1; x <= 113; x += 2)
     {
-        std::cin >> array[i];
+        gallopEnd.push_back(x);
     }
+    for (int x = 500; x <= 506; x++)
+    {
+        gallopEnd.push_back(x);
+    }
+    std::vector<int> sorted = gallopEnd;
+    std::sort(sorted.begin(), sorted.end());
+    SortCount step = 0;
+    SortCount swapCount = 0;
+    timSort(gallopEnd.data(), static_cast<int>(gallopEnd.size()), step, swapCount);
+    check("timSort gallop at run end", gallopEnd == sorted);
+
+    check("networkSort on std::array, N = 0.." + std::to_string(SORTING_NETWORK_MAX),
+          checkArrayNetworks(std::make_index_sequence<SORTING_NETWORK_MAX + 1>()));
+
+    return ok;
 }
 
 constexpr int ARRAY_SIZE = 40000;
 
-int main()
+int main(int argc, char **argv)
 {
+    if (argc > 1 && std::string(argv[1]) == "check")
+    {
+        return runRegressionChecks() ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "scaling")
+    {
+        printScalingReport(argc > 2 ? std::stoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "external")
+    {
+        // Sorts stdin to stdout within the memory budget (64 MiB by default)
+        SortCount step = 0;
+        SortCount swapCount = 0;
+        try
+        {
+            externalSort<int>(std::cin, std::cout, argc > 2 ? std::stoull(argv[2]) : (64ull << 20), step, swapCount);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        std::cerr << "External-> step = " << step << ", swap = " << swapCount << "\n";
+        return 0;
+    }
+    if (argc > 3 && std::string(argv[1]) == "file")
+    {
+        try
+        {
+            sortFile(argv[2], argv[3], argc > 4 ? argv[4] : "text", argc > 5 ? argv[5] : "text");
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "parallel")
+    {
+        printParallelSortReport(argc > 2 ? std::stoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "heavy")
+    {
+        printHeavySortReport(argc > 2 ? std::stoi(argv[2]) : 100000);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "merge")
+    {
+        int size = argc > 2 ? std::stoi(argv[2]) : 10000000;
+        printMergeReport(size, std::max(1, std::min(size, argc > 3 ? std::stoi(argv[3]) : 64)));
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "strings")
+    {
+        printStringSortReport(argc > 2 ? std::stoi(argv[2]) : 1000000);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "select")
+    {
+        // k is 1-based: the k smallest elements, 1 <= k <= size
+        int size = std::max(1, argc > 2 ? std::stoi(argv[2]) : 10000000);
+        printSelectionReport(size, std::max(1, std::min(size, argc > 3 ? std::stoi(argv[3]) : 100)));
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "partition")
+    {
+        printPartitionBenchmark(argc > 2 ? std::stoi(argv[2]) : 10000000);
+        return 0;
+    }
+
     int *array = new int[ARRAY_SIZE];
     int *array2 = new int[ARRAY_SIZE];
     int *array3 = new int[ARRAY_SIZE];
+    int *array4 = new int[ARRAY_SIZE];
+    int *array5 = new int[ARRAY_SIZE];
+    int *array6 = new int[ARRAY_SIZE];
+    int *array7 = new int[ARRAY_SIZE];
 
-    std::array<std::string, 3> sortNames = {"Bubble", "Quick", "Insert"};
+    std::array<std::string, 7> sortNames = {"Bubble", "Quick", "Insert", "Radix", "Intro", "Simd", "Tim"};
 
-    int step[3] = {0, 0, 0};
-    int swapCount[3] = {0, 0, 0};
+    SortCount step[7] = {0, 0, 0, 0, 0, 0, 0};
+    SortCount swapCount[7] = {0, 0, 0, 0, 0, 0, 0};
+    std::array<PerfSample, 7> perf;
 
     // Inverse Array
     //    makeArrayInverse(array, ARRAY_SIZE);
@@ -193,7 +825,7 @@ int main()
 
     for (int i = 0; i < ARRAY_SIZE; i++)
     {
-        array2[i] = array3[i] = array[i];
+        array2[i] = array3[i] = array4[i] = array5[i] = array6[i] = array7[i] = array[i];
     }
 
     std::cout << "Problem > ";
@@ -201,29 +833,55 @@ int main()
     std::cout << std::endl;
 
     std::cout << "Computing bubble sort..." << std::endl;
-    bubbleSort(array, ARRAY_SIZE, step[0], swapCount[0]);
+    perf[0] = measureSort([&] { bubbleSort(array, ARRAY_SIZE, step[0], swapCount[0]); });
     std::cout << "Finish bubble sort." << std::endl;
 
     std::cout << "Computing quick sort..." << std::endl;
-    quickSort(array2, 0, ARRAY_SIZE - 1, step[1], swapCount[1]);
+    perf[1] = measureSort([&] { quickSort(array2, 0, ARRAY_SIZE - 1, step[1], swapCount[1]); });
     std::cout << "Computing quick sort." << std::endl;
 
     std::cout << "Computing insert sort..." << std::endl;
-    insertSort(array3, ARRAY_SIZE, step[2], swapCount[2]);
+    perf[2] = measureSort([&] { insertSort(array3, ARRAY_SIZE, step[2], swapCount[2]); });
     std::cout << "Finish insert sort." << std::endl;
 
+    std::cout << "Computing radix sort..." << std::endl;
+    perf[3] = measureSort([&] { radixSort(array4, ARRAY_SIZE, step[3], swapCount[3]); });
+    std::cout << "Finish radix sort." << std::endl;
+
+    std::cout << "Computing intro sort..." << std::endl;
+    perf[4] = measureSort([&] { introSort(array5, 0, ARRAY_SIZE - 1, step[4], swapCount[4]); });
+    std::cout << "Finish intro sort." << std::endl;
+
+    std::cout << "Computing simd sort..." << std::endl;
+    perf[5] = measureSort([&] { simdQuickSort(array6, 0, ARRAY_SIZE - 1, step[5], swapCount[5]); });
+    std::cout << "Finish simd sort." << std::endl;
+
+    std::cout << "Computing tim sort..." << std::endl;
+    perf[6] = measureSort([&] { timSort(array7, ARRAY_SIZE, step[6], swapCount[6]); });
+    std::cout << "Finish tim sort." << std::endl;
+
     std::cout << "Answer > " << std::endl;
     printArray(array, ARRAY_SIZE);
     std::cout << "\n\n";
 
     std::cout << "Result" << std::endl;
     std::cout << "Problem Size = " << ARRAY_SIZE << std::endl;
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < 7; i++)
     {
-        std::cout << sortNames[i] << "-> step = " << step[i] << ", swap = " << swapCount[i] << "\n";
+        std::cout << sortNames[i] << "-> step = " << step[i] << ", swap = " << swapCount[i];
+        if (perf[i].valid)
+        {
+            std::cout << ", cycles = " << perf[i].cycles << ", instructions = " << perf[i].instructions
+                      << ", cache misses = " << perf[i].cacheMisses << ", branch misses = " << perf[i].branchMisses;
+        }
+        std::cout << "\n";
     }
 
     delete[] array;
     delete[] array2;
     delete[] array3;
+    delete[] array4;
+    delete[] array5;
+    delete[] array6;
+    delete[] array7;
 }
\ No newline at end of file